@@ -0,0 +1,52 @@
+/*
+ * debounce.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Entprellung aller Tasten parallel (vertikaler Zähler, 32 Tasten je Wort)
+ *
+ *  Bit n von cnt[0..DEBOUNCE_BITS-1] bildet zusammen den Zähler für Taste n.
+ *  Eine Taste wechselt ihren stabilen Zustand erst, wenn sie
+ *  DEBOUNCE_SAMPLES aufeinanderfolgende Abtastungen abweicht; jeder
+ *  Rückprall setzt ihren Zähler zurück.
+ */
+
+#ifndef INC_DEBOUNCE_H_
+#define INC_DEBOUNCE_H_
+
+#include <stdint.h>
+
+/* Benötigte gleiche Abtastungen bis zum Zustandswechsel (1..15) */
+#ifndef DEBOUNCE_SAMPLES
+#define DEBOUNCE_SAMPLES  10
+#endif
+
+#if DEBOUNCE_SAMPLES < 1 || DEBOUNCE_SAMPLES > 15
+#error "DEBOUNCE_SAMPLES muss zwischen 1 und 15 liegen"
+#elif DEBOUNCE_SAMPLES < 2
+#define DEBOUNCE_BITS 1
+#elif DEBOUNCE_SAMPLES < 4
+#define DEBOUNCE_BITS 2
+#elif DEBOUNCE_SAMPLES < 8
+#define DEBOUNCE_BITS 3
+#else
+#define DEBOUNCE_BITS 4
+#endif
+
+typedef struct {
+    uint32_t stable;              // entprellter Zustand, 1 = gedrückt
+    uint32_t cnt[DEBOUNCE_BITS];  // vertikaler Zähler
+} debounce_t;
+
+void debounce_init(debounce_t *d);
+
+/**
+ * @brief Verarbeitet eine Abtastung aller Tasten
+ * @param raw     aktueller Rohzustand (1 = gedrückt)
+ * @param press   neu gedrückte Tasten (darf NULL sein)
+ * @param release neu losgelassene Tasten (darf NULL sein)
+ * @return entprellter Zustand
+ */
+uint32_t debounce_sample(debounce_t *d, uint32_t raw, uint32_t *press, uint32_t *release);
+
+#endif /* INC_DEBOUNCE_H_ */
@@ -0,0 +1,37 @@
+/*
+ * defer.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Deferred Work über PendSV (niedrigste Priorität, siehe irq_prio.h)
+ */
+
+#ifndef INC_DEFER_H_
+#define INC_DEFER_H_
+
+#include <stdint.h>
+
+/* Jobs; Bitposition in der Pending-Maske */
+typedef enum {
+    DEFER_RX = 0,        // empfangene Feature-Reports dekodieren
+    DEFER_JOB_COUNT
+} defer_job_t;
+
+typedef void (*defer_fn_t)(void);
+
+/* Statistik je Job */
+typedef struct {
+    uint32_t posts;          // defer_post() Aufrufe
+    uint32_t runs;           // Ausführungen (mehrere Posts -> ein Lauf)
+    uint32_t lat_last_us;    // erster Post -> Start im PendSV
+    uint32_t lat_max_us;
+    uint32_t run_last_us;    // Laufzeit des Jobs
+    uint32_t run_max_us;
+} defer_stats_t;
+
+void defer_register(defer_job_t job, defer_fn_t fn);
+void defer_post(defer_job_t job);      // aus jedem Kontext, auch IRQ
+void defer_run(void);                  // nur aus PendSV_Handler
+void defer_get_stats(defer_stats_t *out);  // Array mit DEFER_JOB_COUNT Einträgen
+
+#endif /* INC_DEFER_H_ */
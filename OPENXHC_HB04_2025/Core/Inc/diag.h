@@ -0,0 +1,64 @@
+/*
+ * diag.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Diagnose über Vendor-Feature-Report 0x07
+ *
+ *  SET_REPORT 0x07: Byte 1 wählt die Seite.
+ *                   Byte 1 = DIAG_CMD_SETTING: Einstellung Byte 2 auf uint32 LE ab [4] setzen.
+ *  GET_REPORT 0x07: [0]=0x07, [1]=Seite, [2]=Anzahl Werte, ab [4] uint32 LE.
+ */
+
+#ifndef INC_DIAG_H_
+#define INC_DIAG_H_
+
+#include <stdint.h>
+
+#define DIAG_REPORT_ID    0x07
+#define DIAG_REPORT_LEN   64      // inkl. Report ID, passt in ein EP0-Paket
+#define DIAG_MAX_VALUES   ((DIAG_REPORT_LEN - 4) / 4)
+
+/* Diagnoseseiten */
+typedef enum {
+    DIAG_PAGE_RX = 0,    // xhc_rx_stats_t: Protokoll/Empfang
+    DIAG_PAGE_IN,        // xhc_in_stats_t: IN-Endpoint
+    DIAG_PAGE_DEFER,     // defer_stats_t[DEFER_JOB_COUNT]: Deferred-Work-Latenz
+    DIAG_PAGE_INPUT,     // keypad_stats_t + selector_stats_t
+    DIAG_PAGE_ENCODER,   // encoder_stats_t
+    DIAG_PAGE_TRACE_EDGE_QUEUE,   // trace_hist_t je Stufe, Reihenfolge wie trace_stage_t
+    DIAG_PAGE_TRACE_QUEUE_SEND,
+    DIAG_PAGE_TRACE_SEND_DONE,
+    DIAG_PAGE_TRACE_EDGE_DONE,
+    DIAG_PAGE_SCHED,     // sched_stats_t: Leerlauf, Laufzeiten je Task
+    DIAG_PAGE_EP0,       // xhc_ep0_stats_t: SET_REPORT 0x06 auf EP0
+    DIAG_PAGE_POWER,     // power_stats_t: Suspend/Resume
+    DIAG_PAGE_SETTINGS,  // settings_stats_t + aktuelle Werte
+    DIAG_PAGE_MEMORY,    // memstat_stats_t: Stack/Heap-Reserve
+    DIAG_PAGE_PROF_MAIN_LOOP,     // prof_zone_stats_t je Zone, Reihenfolge wie prof_zone_t
+    DIAG_PAGE_PROF_USB_IRQ,
+    DIAG_PAGE_PROF_PROCESS_RX,
+    DIAG_PAGE_PROF_WRITE_STRING,
+    DIAG_PAGE_PROF_FILL_RECT,
+    DIAG_PAGE_PROF_EVENTS,        // [0] verworfen, [1] noch im Ring, dann je Ereignis 2 Werte (liest ab)
+    DIAG_PAGE_IDLE,      // idle_stats_t: DMA-Schlaf, Aufwachlatenz
+    DIAG_PAGE_TRACE_SRC_KEYPAD,   // trace_hist_t Flanke -> Report anstehend je Quelle, Reihenfolge wie trace_src_t
+    DIAG_PAGE_TRACE_SRC_SELECTOR,
+    DIAG_PAGE_TRACE_SRC_ENCODER,
+    DIAG_PAGE_COUNT
+} diag_page_t;
+
+#define DIAG_CMD_SETTING  0x80   // Byte 1 des SET_REPORT, keine Seite
+
+void diag_select_page(uint8_t page);
+
+/* SET_REPORT 0x07 (USB-IRQ): Seite wählen oder Einstellung setzen */
+void diag_set_report(const uint8_t *report, uint16_t len);
+
+/* Baut den Report der gewählten Seite (USB-IRQ, GET_REPORT) */
+uint8_t *diag_get_report(uint16_t *len);
+
+/* Werte einer Seite in einen eigenen Puffer (z.B. Telemetrie) */
+uint8_t diag_fill(uint8_t page, uint8_t *dst);
+
+#endif /* INC_DIAG_H_ */
@@ -0,0 +1,29 @@
+/*
+ * dwt.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Zykluszähler (DWT CYCCNT) für Zeitmessungen unterhalb von 1 ms
+ */
+
+#ifndef INC_DWT_H_
+#define INC_DWT_H_
+
+#include "stm32f1xx_hal.h"
+
+/**
+ * @brief Startet den freilaufenden Zykluszähler (einmal beim Boot)
+ */
+static inline void dwt_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/* Aktueller Zählerstand; Differenzen sind über einen Überlauf hinweg gültig (~59 s bei 72 MHz) */
+static inline uint32_t dwt_cycles(void) { return DWT->CYCCNT; }
+
+/* Zyklen -> Mikrosekunden */
+static inline uint32_t dwt_to_us(uint32_t cycles) { return cycles / (SystemCoreClock / 1000000U); }
+
+#endif /* INC_DWT_H_ */
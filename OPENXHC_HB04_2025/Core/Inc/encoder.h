@@ -0,0 +1,47 @@
+/*
+ * encoder.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Handrad (TIM2, 4-fach Quadratur) mit geschwindigkeitsabhängiger Beschleunigung
+ */
+
+#ifndef INC_ENCODER_H_
+#define INC_ENCODER_H_
+
+#include <stdint.h>
+
+/* Zählimpulse je Rastung (4-fach Auswertung, 100 PPR Handrad -> 4) */
+#ifndef ENCODER_COUNTS_PER_DETENT
+#define ENCODER_COUNTS_PER_DETENT  4
+#endif
+
+/* Beschleunigung: 0 = aus (jede Rastung = 1 Schritt) */
+#ifndef ENCODER_ACCEL
+#define ENCODER_ACCEL  1
+#endif
+
+/* Kurve: ab Geschwindigkeit (Rastungen/s) gilt der Faktor; aufsteigend sortiert */
+#ifndef ENCODER_ACCEL_TABLE
+#define ENCODER_ACCEL_TABLE  { {0, 1}, {40, 2}, {80, 4}, {160, 10} }
+#endif
+
+/* Filter der Geschwindigkeit: gleitender Mittelwert mit Gewicht 1/2^n je ms */
+#ifndef ENCODER_VEL_SHIFT
+#define ENCODER_VEL_SHIFT  5
+#endif
+
+typedef struct {
+    int32_t  counts;        // Zählimpulse gesamt (vorzeichenbehaftet)
+    int32_t  detents;       // Rastungen gesamt
+    int32_t  steps;         // an den Report gegebene Schritte (nach Beschleunigung)
+    uint32_t velocity;      // gefilterte Geschwindigkeit, Rastungen/s
+    uint32_t velocity_max;
+    uint32_t multiplier;    // zuletzt angewendeter Faktor
+} encoder_stats_t;
+
+void encoder_init(void);
+void encoder_poll(void);   // SysTick, 1 ms
+void encoder_get_stats(encoder_stats_t *out);
+
+#endif /* INC_ENCODER_H_ */
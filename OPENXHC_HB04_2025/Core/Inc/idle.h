@@ -0,0 +1,86 @@
+/*
+ * idle.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Leerlauf: WFI mit Zeitmessung und Aufwachlatenz
+ *
+ *  Hauptschleife (sched_run) und ST_WaitDMA() schlafen über idle_sleep().
+ *  Aufrufer prüfen ihre Bedingung mit gesperrten IRQs und rufen dann
+ *  idle_sleep(): ein Interrupt nach der Prüfung weckt WFI trotzdem, seine
+ *  ISR läuft erst, wenn idle_sleep() die IRQs kurz freigibt.
+ *
+ *  Aufwachlatenz: jede Eingangs-ISR ruft zuerst idle_isr(). Die erste ISR
+ *  nach dem Aufwachen misst die Zyklen vom Ende des WFI bis zu ihrem
+ *  Eintritt (= was der Schlaf zur ISR-Latenz hinzufügt). Für SysTick ist
+ *  zusätzlich der Anforderungszeitpunkt bekannt (Reload): Latenz aus
+ *  SysTick->VAL, getrennt nach "Kern lief" und "Kern schlief".
+ */
+
+#ifndef INC_IDLE_H_
+#define INC_IDLE_H_
+
+#include <stdint.h>
+#include "stm32f1xx_hal.h"
+#include "dwt.h"
+
+/* Wo geschlafen wird */
+typedef enum {
+    IDLE_SITE_MAIN = 0,   // sched_run: nichts fällig
+    IDLE_SITE_DMA,        // ST_WaitDMA: SPI-DMA läuft
+} idle_site_t;
+
+/* Weckquellen (ISR-Eintritt) */
+typedef enum {
+    IDLE_SRC_USB = 0,
+    IDLE_SRC_DMA_SPI,
+    IDLE_SRC_INPUT,
+    IDLE_SRC_SYSTICK,
+    IDLE_SRC_COUNT
+} idle_src_t;
+
+typedef struct {
+    uint32_t dma_sleeps;                        // WFI beim Warten auf SPI-DMA
+    uint32_t dma_sleep_ms;                      // Schlafzeit darin gesamt
+    uint32_t wake_cycles_last[IDLE_SRC_COUNT];  // WFI-Ende -> Eintritt der ersten ISR
+    uint32_t wake_cycles_max[IDLE_SRC_COUNT];
+    uint32_t tick_lat_run_last;                 // SysTick-Anforderung -> ISR, Kern lief (Zyklen)
+    uint32_t tick_lat_run_max;
+    uint32_t tick_lat_sleep_last;               // ... Kern schlief (WFI)
+    uint32_t tick_lat_sleep_max;
+} idle_stats_t;
+
+extern idle_stats_t      idle_stats;
+extern volatile uint8_t  idle_woken;        // WFI beendet, Wecker-ISR noch nicht gelaufen
+extern uint32_t          idle_wake_cycles;  // DWT beim Ende des WFI
+
+/**
+ * @brief Am Anfang jedes Interrupt-Handlers der Weckquellen (wenige Zyklen)
+ */
+static inline void idle_isr(idle_src_t src) {
+    uint8_t woken = idle_woken;
+
+    if (src == IDLE_SRC_SYSTICK) {
+        /* Zählt abwärts ab LOAD, Anforderung beim Reload */
+        uint32_t lat = SysTick->LOAD - SysTick->VAL;
+        if (woken) {
+            idle_stats.tick_lat_sleep_last = lat;
+            if (lat > idle_stats.tick_lat_sleep_max) idle_stats.tick_lat_sleep_max = lat;
+        } else {
+            idle_stats.tick_lat_run_last = lat;
+            if (lat > idle_stats.tick_lat_run_max) idle_stats.tick_lat_run_max = lat;
+        }
+    }
+    if (woken) {
+        uint32_t c = dwt_cycles() - idle_wake_cycles;
+        idle_woken = 0;
+        idle_stats.wake_cycles_last[src] = c;
+        if (c > idle_stats.wake_cycles_max[src]) idle_stats.wake_cycles_max[src] = c;
+    }
+}
+
+void idle_sleep(idle_site_t site);   // IRQs gesperrt, kehrt mit gesperrten IRQs zurück
+uint32_t idle_cycles(void);          // Schlafzyklen gesamt (läuft über), nur Hauptschleife
+void idle_get_stats(idle_stats_t *out);
+
+#endif /* INC_IDLE_H_ */
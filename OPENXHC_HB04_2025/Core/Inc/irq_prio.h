@@ -0,0 +1,27 @@
+/*
+ * irq_prio.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Interrupt-Prioritäten (NVIC_PRIORITYGROUP_4: 16 Preemption-Stufen, keine Subprioritäten)
+ *
+ *  Regel: Interrupts erledigen nur das Nötigste (Top Half) und geben
+ *  alles Weitere per defer_post() an PendSV ab. Niemals aus einem IRQ
+ *  zeichnen: ST_WaitDMA() wartet auf den DMA-IRQ, der dann ggf. nicht
+ *  durchkommt.
+ *
+ *  CubeMX-verwaltete IRQs (USB, DMA, SysTick, PendSV) stehen zusätzlich
+ *  in der .ioc; beide Stellen gemeinsam ändern.
+ */
+
+#ifndef INC_IRQ_PRIO_H_
+#define INC_IRQ_PRIO_H_
+
+/* 0 bleibt frei (Reserve für harte Echtzeit) */
+#define IRQ_PRIO_USB       1   // USB_LP: Ring füllen, SOF-Reports, EP-Completion
+#define IRQ_PRIO_DMA_SPI   2   // DMA1_Ch3 (SPI1 TX): nur Busy-Flag löschen
+#define IRQ_PRIO_INPUT     3   // Timer/EXTI der Eingabe (Encoder, Tasten, Wahlschalter)
+#define IRQ_PRIO_SYSTICK   4   // HAL-Tick, läuft auch während Deferred Work weiter
+#define IRQ_PRIO_DEFER     15  // PendSV: Deferred Work, unterbrechbar durch alles andere
+
+#endif /* INC_IRQ_PRIO_H_ */
@@ -0,0 +1,59 @@
+/*
+ * keypad.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      4x4 Tastenmatrix, Scan per TIM4 + DMA ohne CPU-Last
+ */
+
+#ifndef INC_KEYPAD_H_
+#define INC_KEYPAD_H_
+
+#include <stdint.h>
+
+/* Zeitschlitz je Zeile (µs) und Einschwingzeit bis zum Abtasten der Spalten.
+ * 50 µs je Zeile -> 200 µs je Matrix-Scan (5 kHz). */
+#ifndef KEYPAD_SLOT_US
+#define KEYPAD_SLOT_US     50
+#endif
+#ifndef KEYPAD_SETTLE_US
+#define KEYPAD_SETTLE_US   40
+#endif
+
+/* Anzahl kompletter Scans im Ringpuffer der Spalten-Snapshots.
+ * keypad_poll() muss laufen, bevor der Ring einmal umläuft (8 Scans = 1,6 ms). */
+#ifndef KEYPAD_SNAP_SCANS
+#define KEYPAD_SNAP_SCANS  8
+#endif
+
+#define KEYPAD_ROWS  4
+#define KEYPAD_COLS  4
+#define KEYPAD_KEYS  (KEYPAD_ROWS * KEYPAD_COLS)
+
+void keypad_init(void);
+
+/* USB-Suspend: Scan anhalten, alle Zeilen aktiv (Weck-EXTI auf den Spalten) */
+void keypad_suspend(void);
+void keypad_resume(void);
+
+/* Letzter vollständiger Scan: Bit (Zeile*4 + Spalte) = 1 -> gedrückt */
+uint16_t keypad_read_raw(void);
+
+/* Neue Scans entprellen und an xhc_set_buttons() weitergeben (SysTick, 1 ms) */
+void keypad_poll(void);
+
+/* Entprellter Zustand (Bitbelegung wie keypad_read_raw) */
+uint16_t keypad_get_state(void);
+
+/* Statistik */
+typedef struct {
+    uint32_t samples;        // entprellte Scans
+    uint32_t presses;
+    uint32_t releases;
+    uint32_t poll_cycles_last;  // Laufzeit keypad_poll (DWT-Zyklen)
+    uint32_t poll_cycles_max;
+} keypad_stats_t;
+
+void keypad_get_stats(keypad_stats_t *out);
+
+#endif /* INC_KEYPAD_H_ */
@@ -0,0 +1,74 @@
+/*
+ * memstat.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      RAM-Reserve: Stack-Hochwassermarke, Heap-Nutzung, Eintrittstiefe je Interrupt-Ebene
+ *
+ *  memstat_paint() füllt zu Beginn von main() den freien RAM zwischen
+ *  Heap-Anfang und aktuellem Stack mit einem Muster. memstat_poll() sucht
+ *  jede Sekunde von unten das erste überschriebene Wort: darüber hat der
+ *  Stack seit dem Boot schon gelegen. Der Heap (_sbrk) wächst von unten in
+ *  denselben Bereich, gescannt wird erst ab seinem Ende.
+ *
+ *  Jeder Interrupt-Handler ruft memstat_isr() mit seiner Prioritätsstufe;
+ *  da sich nur höhere Stufen gegenseitig unterbrechen, entspricht die
+ *  Stufe der Verschachtelungsebene. Gespeichert wird die größte Stacktiefe
+ *  beim Eintritt, also was alle unterbrochenen Ebenen zusammen belegen,
+ *  nicht der eigene Bedarf der Ebene. Der steckt nur in der Eintrittstiefe
+ *  der nächsthöheren Ebene; die oberste (USB) erscheint nur in stack_peak.
+ */
+
+#ifndef INC_MEMSTAT_H_
+#define INC_MEMSTAT_H_
+
+#include <stdint.h>
+#include "stm32f1xx_hal.h"
+
+#define MEMSTAT_PATTERN  0xC5C5C5C5U
+
+#ifndef MEMSTAT_SCAN_MS
+#define MEMSTAT_SCAN_MS  1000
+#endif
+
+/* Prioritätsstufen wie irq_prio.h, von hoch nach niedrig */
+typedef enum {
+    MEMSTAT_LVL_USB = 0,
+    MEMSTAT_LVL_DMA_SPI,
+    MEMSTAT_LVL_INPUT,
+    MEMSTAT_LVL_SYSTICK,
+    MEMSTAT_LVL_DEFER,
+    MEMSTAT_LVL_COUNT
+} memstat_level_t;
+
+typedef struct {
+    uint32_t ram_static;      // .data + .bss (inkl. RAMFUNC-Code)
+    uint32_t ramfunc;         // davon Code im SRAM (ramfunc.h)
+    uint32_t heap_used;       // _sbrk: aktuelles Heap-Ende - _end
+    uint32_t heap_peak;
+    uint32_t heap_fails;      // _sbrk mit ENOMEM abgelehnt
+    uint32_t stack_reserved;  // _Min_Stack_Size (Linkerskript)
+    uint32_t stack_peak;      // tiefste Stacknutzung seit Boot (Byte ab _estack)
+    uint32_t stack_free;      // nie berührter RAM zwischen Heap und Stack
+    uint32_t isr_entry_depth[MEMSTAT_LVL_COUNT];   // Stacktiefe beim Eintritt je Ebene
+} memstat_stats_t;
+
+extern uint32_t memstat_isr_entry[MEMSTAT_LVL_COUNT];
+extern uint8_t _estack;
+
+/**
+ * @brief Am Anfang jedes Interrupt-Handlers (wenige Zyklen)
+ */
+static inline void memstat_isr(memstat_level_t lvl) {
+    uint32_t depth = (uint32_t)&_estack - __get_MSP();
+    if (depth > memstat_isr_entry[lvl]) memstat_isr_entry[lvl] = depth;
+}
+
+void memstat_paint(void);   // main(), vor HAL_Init
+void memstat_poll(void);    // Hauptschleife
+void memstat_get_stats(memstat_stats_t *out);
+
+/* Heap-Zähler aus sysmem.c (_sbrk) */
+void sysmem_get_heap(uint32_t *used, uint32_t *peak, uint32_t *fails);
+
+#endif /* INC_MEMSTAT_H_ */
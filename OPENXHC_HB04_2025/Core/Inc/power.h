@@ -0,0 +1,63 @@
+/*
+ * power.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      USB-Suspend: Anzeige aus, STOP-Modus, Aufwachen per Resume oder Eingabe
+ *
+ *  Der Host meldet Suspend im USB-IRQ; power_poll() (Hauptschleife, nach
+ *  sched_run) schaltet zwischen zwei Durchläufen ab, also nie mitten in
+ *  einem Display-Transfer. Geweckt wird über EXTI: USB-Wakeup (Leitung 18),
+ *  Wahlschalter, Tastenspalten Col1..Col3 und Handrad-Spur A. Col4 (PB8)
+ *  teilt sich EXTI8 mit Rot_X und weckt nicht.
+ */
+
+#ifndef INC_POWER_H_
+#define INC_POWER_H_
+
+#include <stdint.h>
+
+/* Dauer der Resume-Signalisierung beim Remote Wakeup (USB 2.0: 1..15 ms) */
+#ifndef POWER_RWU_SIGNAL_MS
+#define POWER_RWU_SIGNAL_MS  3
+#endif
+
+/* Mindestens so lange muss der Bus im Suspend sein, bevor das Gerät weckt (USB 2.0: 5 ms) */
+#ifndef POWER_RWU_IDLE_MS
+#define POWER_RWU_IDLE_MS    5
+#endif
+
+/* Kommt nach dem USB-Wakeup-EXTI kein Resume/Reset, wieder in STOP */
+#ifndef POWER_WAKE_TIMEOUT_MS
+#define POWER_WAKE_TIMEOUT_MS  50
+#endif
+
+typedef struct {
+    uint32_t suspends;        // Suspend vom Host
+    uint32_t resumes;         // Resume durch Host oder Remote Wakeup
+    uint32_t remote_wakeups;  // vom Pendant ausgelöst
+    uint32_t wakes_ignored;   // Eingabe ohne Remote-Wakeup-Freigabe des Hosts
+    uint32_t stop_entries;    // STOP-Modus betreten
+    uint32_t resume_us_last;  // erster SOF nach Resume -> erster IN-Report abgeholt
+    uint32_t resume_us_max;
+    uint32_t clock_failures;  // HSE/PLL nach STOP nicht rechtzeitig bereit (3 in Folge -> Neustart)
+} power_stats_t;
+
+void power_init(void);
+void power_poll(void);          // Hauptschleife, nach sched_run()
+
+/* Hooks aus dem USB-Treiber (USB-IRQ) */
+void power_usb_suspend(void);
+void power_usb_resume(void);
+void power_usb_reset(void);
+void power_usb_sof(void);
+void power_in_complete(void);
+
+/* Zu Beginn jedes EXTI-Handlers der Eingabe */
+void power_exti_wake(void);
+void power_usb_wakeup_irq(void);   // USBWakeUp_IRQHandler (EXTI18)
+
+uint8_t power_is_suspended(void);
+void power_get_stats(power_stats_t *out);
+
+#endif /* INC_POWER_H_ */
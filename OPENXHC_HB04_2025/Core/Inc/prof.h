@@ -0,0 +1,64 @@
+/*
+ * prof.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Profiling-Zonen mit DWT CYCCNT: Statistik je Zone + Ringpuffer der letzten Ereignisse
+ *
+ *      PROF_BEGIN(PROF_ZONE_FILL_RECT);
+ *      ...
+ *      PROF_END(PROF_ZONE_FILL_RECT);
+ *
+ *  Beide Makros im selben Block; mit PROF_ENABLE=0 entfallen sie ganz.
+ *  Gemessen wird inklusive aller Interrupts, die die Zone unterbrechen.
+ *  Je Zone: Anzahl, Minimum, Maximum, Summe (64 Bit) in Zyklen. Jedes
+ *  Ereignis landet zusätzlich im Ring (PROF_RING_SIZE), ausgelesen über
+ *  die Diagnoseseite DIAG_PAGE_PROF_EVENTS (liest ab, was sie liefert).
+ */
+
+#ifndef INC_PROF_H_
+#define INC_PROF_H_
+
+#include <stdint.h>
+#include "dwt.h"
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE  1
+#endif
+
+#define PROF_RING_SIZE  64u   // Ereignisse (Zweierpotenz), 8 Byte je Ereignis
+
+typedef enum {
+    PROF_ZONE_MAIN_LOOP = 0,   // ein Durchlauf der Hauptschleife (inkl. WFI)
+    PROF_ZONE_USB_IRQ,         // USB_LP_CAN1_RX0_IRQHandler
+    PROF_ZONE_PROCESS_RX,      // xhc_process_received_data (Anzeige eines Frames)
+    PROF_ZONE_WRITE_STRING,    // ST7735_WriteString
+    PROF_ZONE_FILL_RECT,       // ST7735_FillRectangleFast
+    PROF_ZONE_COUNT
+} prof_zone_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t last_cycles;
+    uint32_t total_lo;    // Summe der Zyklen, 64 Bit
+    uint32_t total_hi;
+} prof_zone_stats_t;
+
+#if PROF_ENABLE
+#define PROF_BEGIN(zone)  uint32_t prof_t0_##zone = dwt_cycles()
+#define PROF_END(zone)    prof_record((zone), prof_t0_##zone)
+void prof_record(prof_zone_t zone, uint32_t start_cycles);
+#else
+#define PROF_BEGIN(zone)  do {} while (0)
+#define PROF_END(zone)    do {} while (0)
+#endif
+
+void prof_get_zone(prof_zone_t zone, prof_zone_stats_t *out);
+
+/* Liest bis zu max Ereignisse je 2 Wörter: Start (CYCCNT), Zone << 24 | Dauer (Zyklen, max. 2^24-1).
+ * dropped: seit dem letzten Lesen überschrieben, remaining: danach noch im Ring. */
+uint8_t prof_read_events(uint32_t *dst, uint8_t max, uint32_t *dropped, uint32_t *remaining);
+
+#endif /* INC_PROF_H_ */
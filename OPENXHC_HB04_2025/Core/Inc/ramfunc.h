@@ -0,0 +1,37 @@
+/*
+ * ramfunc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Innere Schleifen aus dem SRAM ausführen (.RamFunc, siehe STM32F103C8TX_FLASH.ld)
+ *
+ *  Bei 72 MHz liest der Kern den Flash mit 2 Waitstates; der Prefetch-Puffer
+ *  hilft nur bei linearem Code, jeder Sprung kostet wieder. Aus dem SRAM
+ *  läuft der Code ohne Waitstates. .RamFunc liegt in .data und wird vom
+ *  Startup mit kopiert – jede Funktion kostet ihre Größe in Flash UND RAM.
+ *  Aufrufe zwischen Flash und RAM gehen über Veneers des Linkers.
+ *
+ *  Auswahl nach Aufbau, nicht nach Messung: Schleifen, die je Glyph, Zeile,
+ *  Chunk oder Tastenabtastung laufen. Ein Zyklenvergleich auf dem Target
+ *  steht noch aus; dafür mit und ohne -DRAMFUNC_DISABLE=1 (alles im Flash)
+ *  bauen und die Diagnosewerte vergleichen: kp.poll_cycles_max (Seite
+ *  input), rx.run_max_us (defer), display.run_max_us (sched).
+ *
+ *  Belegung: tools/ramfunc_report/ramfunc_report.py <elf>
+ */
+
+#ifndef INC_RAMFUNC_H_
+#define INC_RAMFUNC_H_
+
+#ifndef RAMFUNC_DISABLE
+#define RAMFUNC_DISABLE  0
+#endif
+
+/* Wie __RAM_FUNC der HAL, aber nie inline (sonst landet der Code wieder beim Aufrufer im Flash) */
+#if defined(__arm__) && !RAMFUNC_DISABLE
+#define RAMFUNC  __attribute__((section(".RamFunc"), noinline))
+#else
+#define RAMFUNC
+#endif
+
+#endif /* INC_RAMFUNC_H_ */
@@ -0,0 +1,54 @@
+/*
+ * sched.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Kooperativer Scheduler für die Hauptschleife
+ *
+ *  Statische Tasktabelle, jeder Task läuft periodisch (period_ms) und/oder
+ *  auf Ereignisbits (sched_signal, auch aus IRQs). Kein eigener Timer: ist
+ *  nichts fällig, schläft die CPU per WFI bis zum nächsten Interrupt
+ *  (SysTick 1 ms, USB, EXTI, PendSV).
+ */
+
+#ifndef INC_SCHED_H_
+#define INC_SCHED_H_
+
+#include <stdint.h>
+
+/* Tasks in Prioritätsreihenfolge (kleinerer Index läuft zuerst) */
+typedef enum {
+    SCHED_TASK_DISPLAY = 0,   // Anzeige aktualisieren (xhc_main_loop)
+    SCHED_TASK_STATS,         // Raten je Sekunde
+    SCHED_TASK_TELEMETRY,     // CDC-Telemetrie (nur mit USBD_CDC_TELEMETRY angemeldet)
+    SCHED_TASK_COUNT
+} sched_task_t;
+
+/* Ereignisbits */
+#define SCHED_EV_DISPLAY   (1UL << 0)   // neuer Frame oder neue Schalterstellung
+
+typedef void (*sched_fn_t)(void);
+
+/* Statistik je Task */
+typedef struct {
+    uint32_t runs;
+    uint32_t run_last_us;
+    uint32_t run_max_us;
+    uint32_t overruns;       // Laufzeit > Budget oder Periode verpasst
+} sched_task_stats_t;
+
+/* Gesamtstatistik */
+typedef struct {
+    uint32_t idle_permille;  // Anteil WFI in der letzten Sekunde (0..1000), inkl. DMA-Warten
+    uint32_t idle_min_permille;
+    uint32_t wakeups;        // WFI-Aufwachvorgänge der Hauptschleife
+    sched_task_stats_t task[SCHED_TASK_COUNT];
+} sched_stats_t;
+
+void sched_register(sched_task_t task, sched_fn_t fn, uint32_t period_ms,
+                    uint32_t events, uint32_t budget_us);
+void sched_signal(uint32_t events);   // aus jedem Kontext, auch IRQ
+void sched_run(void);                 // ein Durchlauf der Hauptschleife
+void sched_get_stats(sched_stats_t *out);
+
+#endif /* INC_SCHED_H_ */
@@ -0,0 +1,32 @@
+/*
+ * selector.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Achs-/Funktionswahlschalter per EXTI mit Einschwingfenster
+ */
+
+#ifndef INC_SELECTOR_H_
+#define INC_SELECTOR_H_
+
+#include <stdint.h>
+
+/* Nach der letzten Flanke muss der Schalter so lange ruhig sein */
+#ifndef SELECTOR_SETTLE_US
+#define SELECTOR_SETTLE_US  500
+#endif
+
+typedef struct {
+    uint32_t changes;         // übernommene Positionswechsel
+    uint32_t edges;           // EXTI-Flanken
+    uint32_t glitches;        // Flanken ohne Positionswechsel
+    uint32_t poll_changes;    // nur per Polling erkannt (Rot_S, siehe selector.c)
+    uint32_t latency_last_us; // erste Flanke -> Übernahme
+    uint32_t latency_max_us;
+} selector_stats_t;
+
+void selector_init(void);
+void selector_poll(void);   // SysTick, 1 ms
+void selector_get_stats(selector_stats_t *out);
+
+#endif /* INC_SELECTOR_H_ */
@@ -0,0 +1,81 @@
+/*
+ * settings.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Einstellungen im Flash: Log aus 8-Byte-Datensätzen in den letzten zwei Seiten
+ *
+ *  Jede Seite beginnt mit einem Kopf (Magic, Sequenznummer), danach folgen
+ *  Datensätze {uint16 Schlüssel, uint16 CRC, uint32 Wert}. Eine Änderung
+ *  hängt nur einen Datensatz an; der letzte gültige je Schlüssel gilt. Ist
+ *  die aktive Seite voll, werden die aktuellen Werte in die andere Seite
+ *  kopiert (Kompaktierung) – beide Seiten werden abwechselnd gelöscht.
+ *
+ *  Beim Boot liest settings_init() das Log einmal in eine RAM-Tabelle,
+ *  settings_get() liest nur noch RAM. settings_set() merkt die Änderung vor,
+ *  geschrieben wird gesammelt aus der Hauptschleife (settings_poll), wenn
+ *  SETTINGS_FLUSH_DELAY_MS lang nichts mehr geändert wurde.
+ *
+ *  Während Programmieren (~50 us je Halbwort, ~200 us je Datensatz) und
+ *  Löschen (~20 ms je Seite) steht der Flash-Zugriff, also auch jede ISR
+ *  (USB eingeschlossen). Deshalb greift settings_poll() nur auf den Flash
+ *  zu, wenn der Bus ruht (SETTINGS_BUS_IDLE_MS kein Frame vom Host); bei
+ *  laufendem Bus bleiben Änderungen im RAM vorgemerkt, auch beliebig lange.
+ *  Ein Stromausfall vorher verliert sie. In der Ruhe wird die Reserveseite
+ *  vorab gelöscht, damit die Kompaktierung später ohne Löschen auskommt.
+ *  settings_flush() schreibt sofort und ist nur ohne USB-Verkehr erlaubt
+ *  (Host-Test); die Firmware ruft es nicht.
+ */
+
+#ifndef INC_SETTINGS_H_
+#define INC_SETTINGS_H_
+
+#include <stdint.h>
+
+/* Letzte zwei 1-KB-Seiten des 64-KB-Flash, siehe STM32F103C8TX_FLASH.ld */
+#ifndef SETTINGS_FLASH_BASE
+#define SETTINGS_FLASH_BASE  0x0800F800U
+#endif
+#define SETTINGS_PAGE_SIZE   0x400U
+#define SETTINGS_PAGES       2U
+
+/* Ruhezeit nach der letzten Änderung, bevor geschrieben wird */
+#ifndef SETTINGS_FLUSH_DELAY_MS
+#define SETTINGS_FLUSH_DELAY_MS  2000
+#endif
+
+/* So lange ohne Frame vom Host gilt der Bus als ruhig (Flash-Zugriff erlaubt) */
+#ifndef SETTINGS_BUS_IDLE_MS
+#define SETTINGS_BUS_IDLE_MS     3000
+#endif
+
+typedef enum {
+    SETTINGS_KEY_ENC_REVERSE = 0,   // Handrad-Richtung umkehren (0/1)
+    SETTINGS_KEY_ENC_ACCEL,         // Handrad-Beschleunigung (0/1), Vorgabe ENCODER_ACCEL
+    SETTINGS_KEY_DISPLAY_FLIP,      // Anzeige um 180° drehen (0/1), wirkt nach Neustart
+    SETTINGS_KEY_COUNT
+} settings_key_t;
+
+typedef struct {
+    uint32_t seq;             // Sequenznummer der aktiven Seite (= Kompaktierungen gesamt)
+    uint32_t active_page;     // 0/1, 0xFFFFFFFF = Flash leer
+    uint32_t used_slots;      // belegte Datensätze der aktiven Seite
+    uint32_t free_slots;
+    uint32_t loaded;          // gültige Datensätze beim Boot
+    uint32_t crc_errors;      // beim Boot verworfene Datensätze (CRC, Schlüssel, abgebrochen)
+    uint32_t scan_us;         // Boot-Scan
+    uint32_t writes;          // geschriebene Datensätze seit Boot
+    uint32_t compactions;     // seit Boot
+    uint32_t flash_errors;    // HAL-Fehler beim Programmieren/Löschen
+    uint32_t write_us_max;    // ein Datensatz
+    uint32_t erase_us_max;    // Kompaktierung inkl. Löschen
+} settings_stats_t;
+
+void settings_init(void);                 // vor allen Nutzern, liest das Log
+uint32_t settings_get(settings_key_t key);
+void settings_set(settings_key_t key, uint32_t value);   // jeder Kontext, nur RAM
+void settings_poll(uint8_t bus_idle);     // Hauptschleife, schreibt verzögert und nur bei bus_idle
+void settings_flush(void);                // sofort schreiben, auch mit Löschen (nur ohne USB)
+void settings_get_stats(settings_stats_t *out);
+
+#endif /* INC_SETTINGS_H_ */
@@ -0,0 +1,42 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Binärer Telemetrie-Strom über CDC-ACM (nur mit USBD_CDC_TELEMETRY)
+ *
+ *  Alle TELEMETRY_PERIOD_MS Diagnoseseiten reihum, je Seite ein Datensatz,
+ *  so viele wie in den Sendepuffer passen (der Rest folgt im nächsten
+ *  Durchlauf), solange das Terminal offen ist (DTR):
+ *      [0]   0xA5
+ *      [1]   0x5A
+ *      [2]   Seite (diag_page_t)
+ *      [3]   n = Anzahl Werte
+ *      [4]   uint16 Sequenznummer (Lücken = verworfene Datensätze)
+ *      [6]   uint32 HAL_GetTick
+ *      [10]  n * uint32 Werte wie im Diagnose-Report 0x07
+ *      [..]  uint16 CRC-16/CCITT (0xFFFF) über Byte 2 bis Ende der Werte
+ *  Alles Little Endian. Dekodieren mit tools/xhc_telemetry/tlm2csv.py.
+ */
+
+#ifndef INC_TELEMETRY_H_
+#define INC_TELEMETRY_H_
+
+#include <stdint.h>
+#include "usbd_conf.h"
+
+#ifndef TELEMETRY_PERIOD_MS
+#define TELEMETRY_PERIOD_MS  100
+#endif
+
+#define TELEMETRY_RING_SIZE  1024u   // Sendepuffer (Zweierpotenz)
+
+#if USBD_CDC_TELEMETRY
+void telemetry_init(void);
+void telemetry_tx_done(void);   // Bulk-IN Paket abgeholt (USB-IRQ)
+void telemetry_reset(void);     // Klasse (de)initialisiert, z. B. Bus-Reset (USB-IRQ)
+#else
+static inline void telemetry_init(void) {}
+#endif
+
+#endif /* INC_TELEMETRY_H_ */
@@ -0,0 +1,66 @@
+/*
+ * trace.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Latenzmessung Eingabe -> USB mit DWT CYCCNT
+ *
+ *  Stufen je Tastendruck / Rastung / Schalterwechsel:
+ *      Flanke --(EDGE_QUEUE)--> Report anstehend --(QUEUE_SEND)-->
+ *      SendReport --(SEND_DONE)--> DataIn (Host hat abgeholt)
+ *  plus Gesamtzeit Flanke -> DataIn (EDGE_DONE). EDGE_QUEUE gibt es
+ *  zusätzlich je Quelle (trace_get_src_hist), die Stufen danach fassen
+ *  mehrere Änderungen in einem Report zusammen und bleiben gemeinsam.
+ *
+ *  Histogramme mit log2-Klassen in µs: Klasse 0 = <2 µs, Klasse i = [2^i, 2^(i+1)),
+ *  letzte Klasse = alles ab 2^(TRACE_BUCKETS-1) µs (16 ms).
+ */
+
+#ifndef INC_TRACE_H_
+#define INC_TRACE_H_
+
+#include <stdint.h>
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE  1
+#endif
+
+#define TRACE_BUCKETS  15   // passt als uint32 in eine Diagnoseseite
+#define TRACE_INFLIGHT 4    // Reports zwischen SendReport und DataIn (>= XHC_IN_QUEUE_MAX)
+
+typedef enum {
+    TRACE_SRC_KEYPAD = 0,
+    TRACE_SRC_SELECTOR,
+    TRACE_SRC_ENCODER,
+    TRACE_SRC_COUNT
+} trace_src_t;
+
+typedef enum {
+    TRACE_EDGE_QUEUE = 0,
+    TRACE_QUEUE_SEND,
+    TRACE_SEND_DONE,
+    TRACE_EDGE_DONE,
+    TRACE_STAGE_COUNT
+} trace_stage_t;
+
+typedef struct {
+    uint32_t bucket[TRACE_BUCKETS];
+} trace_hist_t;
+
+#if TRACE_ENABLE
+void trace_input(trace_src_t src, uint32_t edge_cycles);   // vor xhc_set_* / xhc_add_wheel
+void trace_send(uint32_t queued_cycles, uint32_t tx_cycles, uint8_t pending);  // jeder gesendete Report
+void trace_done(uint32_t tx_cycles, uint32_t done_cycles);
+void trace_flush(void);   // Reports verworfen (USB-Reset)
+#else
+static inline void trace_input(trace_src_t src, uint32_t edge_cycles) { (void)src; (void)edge_cycles; }
+static inline void trace_send(uint32_t queued_cycles, uint32_t tx_cycles, uint8_t pending) { (void)queued_cycles; (void)tx_cycles; (void)pending; }
+static inline void trace_done(uint32_t tx_cycles, uint32_t done_cycles) { (void)tx_cycles; (void)done_cycles; }
+static inline void trace_flush(void) {}
+#endif
+
+void trace_get_hist(trace_stage_t stage, trace_hist_t *out);
+void trace_get_src_hist(trace_src_t src, trace_hist_t *out);   // EDGE_QUEUE einer Quelle
+void trace_reset(void);
+
+#endif /* INC_TRACE_H_ */
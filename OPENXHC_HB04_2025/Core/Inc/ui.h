@@ -52,6 +52,7 @@ void UI_UpdateBarF(uint8_t percent);           // 0..100
 void UI_UpdateStatus(const char *status);     // Allgemeiner Status
 void UI_UpdateFeedrate(uint16_t feedrate, uint16_t override);
 void UI_UpdateSpindle(uint16_t speed, uint16_t override);
+void UI_SetActiveAxis(int8_t axis);            // 0..2 = X/Y/Z hervorheben, -1 = keine
 
 // Hilfsfunktion für zeichenweise Updates (intern)
 void UI_UpdateValue(int y_pos, float value, char *cache_str, int cache_size);
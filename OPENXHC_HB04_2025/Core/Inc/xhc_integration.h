@@ -26,6 +26,30 @@
 #define ROTARY_SPINDLE 0x15
 #define ROTARY_FEED    0x16
 
+/* Input-Reports: gesendet wird bei Zustandsänderung im nächsten USB-Frame,
+ * ohne Änderung nur ein Keepalive in diesem Intervall */
+#ifndef XHC_KEEPALIVE_MS
+#define XHC_KEEPALIVE_MS 1000
+#endif
+
+/* Mindestabstand zwischen zwei IN-Reports im Standardmodus.
+ * Mit XHC_LOW_LATENCY (usbd_conf.h) entfällt er, dann begrenzt nur der
+ * belegte Endpoint (bInterval 1 ms). */
+#ifndef XHC_IN_MIN_INTERVAL_MS
+#define XHC_IN_MIN_INTERVAL_MS 10
+#endif
+
+/* Reports gleichzeitig unterwegs: einer am Endpoint, die übrigen in der
+ * Report-FIFO des Klassentreibers (wird in der DataIn-Completion nachgeladen) */
+#ifndef XHC_IN_QUEUE_MAX
+#define XHC_IN_QUEUE_MAX 2
+#endif
+
+/* Schalterstellungen mit eigenen Handrad-Schritten hinter einem offenen Rest */
+#ifndef XHC_WHEEL_QUEUE
+#define XHC_WHEEL_QUEUE 8
+#endif
+
 #pragma pack(push, 1)
 
 /* Host→Device Data Structure */
@@ -59,6 +83,46 @@ struct whb0x_in_data {
 
 #pragma pack(pop)
 
+/* IN-Endpoint Statistik */
+typedef struct {
+    uint32_t in_sent;        // gestartete Transfers
+    uint32_t in_completed;   // DataIn-Completions gesamt
+    uint32_t in_per_sec;     // Completions in der letzten Sekunde
+    uint32_t busy_frames;    // Frames mit wartendem Report, Warteschlange voll
+    uint32_t wait_last_us;   // Zustandsänderung -> Transmit
+    uint32_t wait_avg_us;
+    uint32_t wait_max_us;
+    uint32_t poll_last_us;   // Bereitstellung am Endpoint -> Abholung durch Host
+    uint32_t poll_max_us;
+    uint32_t carry_reports;  // Reports mit Übertrag (Handrad > int8)
+    uint32_t carry_last;     // Rest nach dem letzten Report (Schritte)
+    uint32_t carry_max;
+    uint32_t prearmed;       // Reports hinter einem laufenden Transfer eingereiht
+    uint32_t get_reports;    // GET_REPORT 0x04 über EP0 beantwortet
+    uint32_t boot_report_ms; // Reset -> erster IN-Report abgeholt (HAL-Tick)
+} xhc_in_stats_t;
+
+/* Schalterwechsel bei offenem Handrad-Rest */
+typedef struct {
+    uint32_t mode_holds;     // Wechsel hinter einem offenen Rest eingereiht
+    uint32_t steps_dropped;  // verworfen: Suspend ohne Remote Wakeup, Warteschlange voll
+} xhc_wheel_stats_t;
+
+/* Empfangs-/Protokollstatistik (Host→Device Frames) */
+typedef struct {
+    uint32_t frames;         // vollständige Frames
+    uint32_t frames_per_sec; // Frames in der letzten Sekunde
+    uint32_t duplicates;     // Frame identisch zum vorherigen
+    uint32_t resyncs;        // Magic nach verworfenen Chunks wiedergefunden
+    uint32_t incomplete;     // Frame durch neues Magic abgebrochen
+    uint32_t orphan_chunks;  // Chunks ohne vorheriges Magic verworfen
+    uint32_t overflow;       // Chunks verworfen, Puffer voll
+    uint32_t gap_last_us;    // Abstand der letzten zwei Frames
+    uint32_t gap_max_us;
+    uint32_t ring_dropped;   // Ringpuffer voll (USB-IRQ)
+    uint32_t ring_highwater;
+} xhc_rx_stats_t;
+
 /* Global Variables */
 extern struct whb04_out_data xhc_output_report;
 extern struct whb0x_in_data xhc_input_report;
@@ -66,11 +130,25 @@ extern uint8_t xhc_day;
 
 /* Core Functions */
 void xhc_init(void);
-void xhc_main_loop(void);
+void xhc_main_loop(void);   // Anzeige-Task, siehe sched.h
 
 /* USB Communication */
-void xhc_receive_data(uint8_t *data);
+void xhc_receive_data(const uint8_t *data);
+void xhc_rx_work(void);   // Deferred Work (PendSV), siehe defer.h
 uint8_t xhc_send_input_report(uint8_t btn1, uint8_t btn2, uint8_t wheel_mode, int8_t wheel_value);
+void xhc_usb_sof(void);   // aus HAL_PCD_SOFCallback (USB-IRQ, 1 ms)
+void xhc_usb_resume(uint8_t keep_wheel);   // nach USB-Suspend: aktuellen Zustand im ersten Frame senden
+void xhc_in_complete(void);  // IN-Transfer vom Host abgeholt (USB-IRQ)
+uint8_t *xhc_get_input_report(uint16_t *len);  // GET_REPORT 0x04 (USB-IRQ)
+void xhc_get_in_stats(xhc_in_stats_t *out);
+void xhc_get_rx_stats(xhc_rx_stats_t *out);
+uint32_t xhc_rx_idle_ms(void);   // seit dem letzten Chunk vom Host
+
+/* Input State (lösen einen Report im nächsten Frame aus) */
+void xhc_set_buttons(uint8_t btn1, uint8_t btn2);
+void xhc_set_wheel_mode(uint8_t wheel_mode);
+void xhc_add_wheel(int32_t delta);
+void xhc_get_wheel_stats(xhc_wheel_stats_t *out);
 
 /* Data Processing */
 void xhc_process_received_data(void);
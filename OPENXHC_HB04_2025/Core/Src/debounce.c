@@ -0,0 +1,44 @@
+/*
+ * debounce.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Entprellung aller Tasten parallel (vertikaler Zähler)
+ */
+
+#include "debounce.h"
+#include "ramfunc.h"
+#include <string.h>
+
+/**
+ * @brief Setzt alle Tasten auf "losgelassen" und die Zähler auf 0
+ */
+void debounce_init(debounce_t *d) {
+    memset(d, 0, sizeof(*d));
+}
+
+RAMFUNC uint32_t debounce_sample(debounce_t *d, uint32_t raw, uint32_t *press, uint32_t *release) {
+    uint32_t delta = raw ^ d->stable;   // weicht vom stabilen Zustand ab
+    uint32_t carry = delta;
+    uint32_t hit = delta;
+
+    /* Zähler +1 für abweichende Tasten, 0 für alle anderen;
+     * gleichzeitig prüfen, ob der Zähler DEBOUNCE_SAMPLES erreicht hat */
+    for (int b = 0; b < DEBOUNCE_BITS; b++) {
+        uint32_t c = d->cnt[b];
+        uint32_t next = (c ^ carry) & delta;
+        carry &= c;
+        d->cnt[b] = next;
+        hit &= ((DEBOUNCE_SAMPLES >> b) & 1) ? next : ~next;
+    }
+
+    /* Erreicht: Zustand umschalten, Zähler zurücksetzen */
+    d->stable ^= hit;
+    for (int b = 0; b < DEBOUNCE_BITS; b++) {
+        d->cnt[b] &= ~hit;
+    }
+
+    if (press)   *press = hit & d->stable;
+    if (release) *release = hit & ~d->stable;
+    return d->stable;
+}
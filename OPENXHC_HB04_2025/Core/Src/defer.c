@@ -0,0 +1,88 @@
+/*
+ * defer.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Deferred Work über PendSV
+ */
+
+#include "defer.h"
+#include "dwt.h"
+#include "irq_prio.h"
+#include <string.h>
+
+/* HAL-Tick aus stm32f1xx_hal_conf.h muss zum Prioritätsplan passen */
+_Static_assert(TICK_INT_PRIORITY == IRQ_PRIO_SYSTICK, "TICK_INT_PRIORITY != IRQ_PRIO_SYSTICK");
+
+static defer_fn_t        jobs[DEFER_JOB_COUNT];
+static volatile uint32_t pending = 0;                  // Bit je Job
+static volatile uint32_t post_cycles[DEFER_JOB_COUNT]; // DWT: erster Post seit letztem Lauf
+static defer_stats_t     stats[DEFER_JOB_COUNT];
+
+/**
+ * @brief Hinterlegt die Funktion eines Jobs (vor dem ersten Post)
+ */
+void defer_register(defer_job_t job, defer_fn_t fn) {
+    if (job < DEFER_JOB_COUNT) jobs[job] = fn;
+}
+
+/**
+ * @brief Markiert einen Job und löst PendSV aus
+ */
+void defer_post(defer_job_t job) {
+    if (job >= DEFER_JOB_COUNT) return;
+
+    uint32_t bit = 1UL << job;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!(pending & bit)) {
+        post_cycles[job] = dwt_cycles();
+        pending |= bit;
+    }
+    stats[job].posts++;
+    __set_PRIMASK(primask);
+
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/**
+ * @brief Führt alle anstehenden Jobs aus, bis keiner mehr ansteht (PendSV)
+ */
+void defer_run(void) {
+    for (;;) {
+        uint32_t t_post[DEFER_JOB_COUNT];
+
+        __disable_irq();
+        uint32_t todo = pending;
+        pending = 0;
+        for (uint32_t i = 0; i < DEFER_JOB_COUNT; i++) t_post[i] = post_cycles[i];
+        __enable_irq();
+
+        if (!todo) break;
+
+        for (uint32_t i = 0; i < DEFER_JOB_COUNT; i++) {
+            if (!(todo & (1UL << i)) || !jobs[i]) continue;
+
+            uint32_t start = dwt_cycles();
+            jobs[i]();
+            uint32_t end = dwt_cycles();
+
+            defer_stats_t *s = &stats[i];
+            s->runs++;
+            s->lat_last_us = dwt_to_us(start - t_post[i]);
+            if (s->lat_last_us > s->lat_max_us) s->lat_max_us = s->lat_last_us;
+            s->run_last_us = dwt_to_us(end - start);
+            if (s->run_last_us > s->run_max_us) s->run_max_us = s->run_last_us;
+        }
+    }
+}
+
+/**
+ * @brief Liefert die Statistik aller Jobs (Kopie)
+ */
+void defer_get_stats(defer_stats_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(out, stats, sizeof(stats));
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,224 @@
+/*
+ * diag.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Diagnose über Vendor-Feature-Report 0x07
+ */
+
+#include "diag.h"
+#include "xhc_integration.h"
+#include "defer.h"
+#include "keypad.h"
+#include "selector.h"
+#include "encoder.h"
+#include "trace.h"
+#include "sched.h"
+#include "power.h"
+#include "settings.h"
+#include "memstat.h"
+#include "prof.h"
+#include "idle.h"
+#include "usbd_custom_hid_if.h"
+#include <string.h>
+
+static uint8_t diag_page = DIAG_PAGE_RX;
+static uint8_t diag_buf[DIAG_REPORT_LEN];   // bleibt bis zum Ende der Control-Übertragung gültig
+
+/* Statistikstrukturen bestehen nur aus uint32 und passen in einen Report */
+_Static_assert(sizeof(xhc_rx_stats_t) <= DIAG_MAX_VALUES * 4, "xhc_rx_stats_t zu groß für Diagnose-Report");
+_Static_assert(sizeof(xhc_in_stats_t) <= DIAG_MAX_VALUES * 4, "xhc_in_stats_t zu groß für Diagnose-Report");
+_Static_assert(sizeof(defer_stats_t) * DEFER_JOB_COUNT <= DIAG_MAX_VALUES * 4, "defer_stats_t zu groß für Diagnose-Report");
+_Static_assert(sizeof(encoder_stats_t) + sizeof(xhc_wheel_stats_t) <= DIAG_MAX_VALUES * 4, "Handradstatistik zu groß für Diagnose-Report");
+_Static_assert(sizeof(trace_hist_t) <= DIAG_MAX_VALUES * 4, "trace_hist_t zu groß für Diagnose-Report");
+_Static_assert(DIAG_PAGE_TRACE_EDGE_DONE - DIAG_PAGE_TRACE_EDGE_QUEUE == TRACE_EDGE_DONE, "eine Diagnoseseite je Trace-Stufe");
+_Static_assert(DIAG_PAGE_TRACE_SRC_ENCODER - DIAG_PAGE_TRACE_SRC_KEYPAD == TRACE_SRC_COUNT - 1, "eine Diagnoseseite je Trace-Quelle");
+_Static_assert(sizeof(sched_stats_t) <= DIAG_MAX_VALUES * 4, "sched_stats_t zu groß für Diagnose-Report");
+_Static_assert(sizeof(xhc_ep0_stats_t) <= DIAG_MAX_VALUES * 4, "xhc_ep0_stats_t zu groß für Diagnose-Report");
+_Static_assert(sizeof(power_stats_t) <= DIAG_MAX_VALUES * 4, "power_stats_t zu groß für Diagnose-Report");
+_Static_assert(sizeof(settings_stats_t) + SETTINGS_KEY_COUNT * 4 <= DIAG_MAX_VALUES * 4, "Einstellungen zu groß für Diagnose-Report");
+_Static_assert(sizeof(memstat_stats_t) <= DIAG_MAX_VALUES * 4, "memstat_stats_t zu groß für Diagnose-Report");
+_Static_assert(sizeof(prof_zone_stats_t) <= DIAG_MAX_VALUES * 4, "prof_zone_stats_t zu groß für Diagnose-Report");
+_Static_assert(DIAG_PAGE_PROF_FILL_RECT - DIAG_PAGE_PROF_MAIN_LOOP == PROF_ZONE_COUNT - 1, "eine Diagnoseseite je Profiling-Zone");
+_Static_assert(sizeof(idle_stats_t) <= DIAG_MAX_VALUES * 4, "idle_stats_t zu groß für Diagnose-Report");
+_Static_assert(DIAG_PAGE_COUNT <= DIAG_CMD_SETTING, "Seitennummer kollidiert mit Kommando");
+_Static_assert(sizeof(keypad_stats_t) + sizeof(selector_stats_t) <= DIAG_MAX_VALUES * 4, "Eingabestatistik zu groß für Diagnose-Report");
+
+/**
+ * @brief Wählt die Seite für den nächsten GET_REPORT (unbekannte -> Seite 0)
+ */
+void diag_select_page(uint8_t page) {
+    diag_page = (page < DIAG_PAGE_COUNT) ? page : DIAG_PAGE_RX;
+}
+
+/**
+ * @brief SET_REPORT 0x07: Seite wählen oder Einstellung setzen (geschrieben
+ *        wird verzögert aus der Hauptschleife, siehe settings.h)
+ */
+void diag_set_report(const uint8_t *report, uint16_t len) {
+    if (len < 2) return;
+
+    if (report[1] == DIAG_CMD_SETTING) {
+        if (len < 8) return;
+        uint32_t value = (uint32_t)report[4] | (uint32_t)report[5] << 8 |
+                         (uint32_t)report[6] << 16 | (uint32_t)report[7] << 24;
+        settings_set((settings_key_t)report[2], value);
+        return;
+    }
+    diag_select_page(report[1]);
+}
+
+/**
+ * @brief Kopiert die Werte einer Seite (uint32 LE) nach dst
+ * @param dst mindestens DIAG_MAX_VALUES * 4 Byte
+ * @return Anzahl Werte
+ */
+uint8_t diag_fill(uint8_t page, uint8_t *dst) {
+    uint8_t n = 0;
+
+    switch (page) {
+    case DIAG_PAGE_IN: {
+        xhc_in_stats_t s;
+        xhc_get_in_stats(&s);
+        memcpy(dst, &s, sizeof(s));
+        n = sizeof(s) / 4;
+        break;
+    }
+    case DIAG_PAGE_DEFER: {
+        defer_stats_t s[DEFER_JOB_COUNT];
+        defer_get_stats(s);
+        memcpy(dst, s, sizeof(s));
+        n = sizeof(s) / 4;
+        break;
+    }
+    case DIAG_PAGE_INPUT: {
+        keypad_stats_t k;
+        selector_stats_t s;
+        keypad_get_stats(&k);
+        selector_get_stats(&s);
+        memcpy(dst, &k, sizeof(k));
+        memcpy(&dst[sizeof(k)], &s, sizeof(s));
+        n = (sizeof(k) + sizeof(s)) / 4;
+        break;
+    }
+    case DIAG_PAGE_ENCODER: {
+        encoder_stats_t s;
+        xhc_wheel_stats_t w;
+        encoder_get_stats(&s);
+        xhc_get_wheel_stats(&w);
+        memcpy(dst, &s, sizeof(s));
+        memcpy(&dst[sizeof(s)], &w, sizeof(w));
+        n = (sizeof(s) + sizeof(w)) / 4;
+        break;
+    }
+    case DIAG_PAGE_TRACE_EDGE_QUEUE:
+    case DIAG_PAGE_TRACE_QUEUE_SEND:
+    case DIAG_PAGE_TRACE_SEND_DONE:
+    case DIAG_PAGE_TRACE_EDGE_DONE: {
+        trace_hist_t h;
+        trace_get_hist((trace_stage_t)(page - DIAG_PAGE_TRACE_EDGE_QUEUE), &h);
+        memcpy(dst, &h, sizeof(h));
+        n = sizeof(h) / 4;
+        break;
+    }
+    case DIAG_PAGE_SCHED: {
+        sched_stats_t s;
+        sched_get_stats(&s);
+        memcpy(dst, &s, sizeof(s));
+        n = sizeof(s) / 4;
+        break;
+    }
+    case DIAG_PAGE_EP0: {
+        xhc_ep0_stats_t s;
+        XHC_EP0_GetStats(&s);
+        memcpy(dst, &s, sizeof(s));
+        n = sizeof(s) / 4;
+        break;
+    }
+    case DIAG_PAGE_POWER: {
+        power_stats_t s;
+        power_get_stats(&s);
+        memcpy(dst, &s, sizeof(s));
+        n = sizeof(s) / 4;
+        break;
+    }
+    case DIAG_PAGE_SETTINGS: {
+        settings_stats_t s;
+        settings_get_stats(&s);
+        memcpy(dst, &s, sizeof(s));
+        n = sizeof(s) / 4;
+        for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) {
+            uint32_t v = settings_get((settings_key_t)k);
+            memcpy(&dst[n * 4], &v, sizeof(v));
+            n++;
+        }
+        break;
+    }
+    case DIAG_PAGE_MEMORY: {
+        memstat_stats_t s;
+        memstat_get_stats(&s);
+        memcpy(dst, &s, sizeof(s));
+        n = sizeof(s) / 4;
+        break;
+    }
+    case DIAG_PAGE_PROF_MAIN_LOOP:
+    case DIAG_PAGE_PROF_USB_IRQ:
+    case DIAG_PAGE_PROF_PROCESS_RX:
+    case DIAG_PAGE_PROF_WRITE_STRING:
+    case DIAG_PAGE_PROF_FILL_RECT: {
+        prof_zone_stats_t s;
+        prof_get_zone((prof_zone_t)(page - DIAG_PAGE_PROF_MAIN_LOOP), &s);
+        memcpy(dst, &s, sizeof(s));
+        n = sizeof(s) / 4;
+        break;
+    }
+    case DIAG_PAGE_PROF_EVENTS: {
+        uint32_t v[DIAG_MAX_VALUES];
+        uint8_t events = prof_read_events(&v[2], (DIAG_MAX_VALUES - 2) / 2, &v[0], &v[1]);
+        n = (uint8_t)(2 + 2 * events);
+        memcpy(dst, v, n * 4u);
+        break;
+    }
+    case DIAG_PAGE_TRACE_SRC_KEYPAD:
+    case DIAG_PAGE_TRACE_SRC_SELECTOR:
+    case DIAG_PAGE_TRACE_SRC_ENCODER: {
+        trace_hist_t h;
+        trace_get_src_hist((trace_src_t)(page - DIAG_PAGE_TRACE_SRC_KEYPAD), &h);
+        memcpy(dst, &h, sizeof(h));
+        n = sizeof(h) / 4;
+        break;
+    }
+    case DIAG_PAGE_IDLE: {
+        idle_stats_t s;
+        idle_get_stats(&s);
+        memcpy(dst, &s, sizeof(s));
+        n = sizeof(s) / 4;
+        break;
+    }
+    case DIAG_PAGE_RX:
+    default: {
+        xhc_rx_stats_t s;
+        xhc_get_rx_stats(&s);
+        memcpy(dst, &s, sizeof(s));
+        n = sizeof(s) / 4;
+        break;
+    }
+    }
+
+    return n;
+}
+
+/**
+ * @brief Füllt den Diagnose-Report der gewählten Seite
+ * @param len Länge des Reports
+ * @return Zeiger auf den statischen Report-Puffer
+ */
+uint8_t *diag_get_report(uint16_t *len) {
+    memset(diag_buf, 0, sizeof(diag_buf));
+    diag_buf[0] = DIAG_REPORT_ID;
+    diag_buf[1] = diag_page;
+    diag_buf[2] = diag_fill(diag_page, &diag_buf[4]);
+
+    *len = DIAG_REPORT_LEN;
+    return diag_buf;
+}
@@ -0,0 +1,121 @@
+/*
+ * encoder.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Handrad (TIM2, 4-fach Quadratur) mit geschwindigkeitsabhängiger Beschleunigung
+ *
+ *  TIM2 zählt im Encoder-Modus TI12 beide Kanäle, beide Flanken. Jede
+ *  Millisekunde wird die Differenz gelesen; Reste unterhalb einer Rastung
+ *  bleiben erhalten, es geht kein Zählimpuls verloren.
+ */
+
+#include "encoder.h"
+#include "tim.h"
+#include "xhc_integration.h"
+#include "dwt.h"
+#include "trace.h"
+#include "settings.h"
+#include <string.h>
+
+typedef struct {
+    uint32_t min_velocity;   // Rastungen/s
+    uint32_t factor;
+} accel_step_t;
+
+#if ENCODER_ACCEL
+static const accel_step_t accel_table[] = ENCODER_ACCEL_TABLE;
+#endif
+
+static uint16_t last_cnt = 0;
+static int32_t  residual = 0;       // Zählimpulse unterhalb einer Rastung
+static uint32_t edge_cycles = 0;    // DWT: erster Zählimpuls seit der letzten Rastung (1 ms Auflösung)
+static uint8_t  edge_valid = 0;
+static int32_t  vel_filt = 0;       // Rastungen/s << ENCODER_VEL_SHIFT
+static volatile uint8_t running = 0;
+static encoder_stats_t stats;
+
+/**
+ * @brief Startet TIM2 im Encoder-Modus (nach MX_TIM2_Init)
+ */
+void encoder_init(void) {
+    HAL_TIM_Encoder_Start(&htim2, TIM_CHANNEL_ALL);
+    last_cnt = (uint16_t)__HAL_TIM_GET_COUNTER(&htim2);
+    residual = 0;
+    vel_filt = 0;
+    running = 1;
+}
+
+static uint32_t accel_factor(uint32_t velocity) {
+#if ENCODER_ACCEL
+    uint32_t f = 1;
+    if (!settings_get(SETTINGS_KEY_ENC_ACCEL)) return 1;
+    for (uint32_t i = 0; i < sizeof(accel_table) / sizeof(accel_table[0]); i++) {
+        if (velocity >= accel_table[i].min_velocity) f = accel_table[i].factor;
+    }
+    return f;
+#else
+    (void)velocity;
+    return 1;
+#endif
+}
+
+/**
+ * @brief Liest die Zähldifferenz, filtert die Geschwindigkeit und
+ *        gibt (beschleunigte) Rastungen an den Input-Report
+ */
+void encoder_poll(void) {
+    if (!running) return;
+
+    uint16_t cnt = (uint16_t)__HAL_TIM_GET_COUNTER(&htim2);
+    int16_t delta = (int16_t)(cnt - last_cnt);   // Überlauf des 16-Bit-Zählers inklusive
+    last_cnt = cnt;
+    if (settings_get(SETTINGS_KEY_ENC_REVERSE)) delta = (int16_t)-delta;
+
+    if (delta != 0 && !edge_valid) {
+        edge_cycles = dwt_cycles();
+        edge_valid = 1;
+    }
+
+    residual += delta;
+    int32_t detents = residual / ENCODER_COUNTS_PER_DETENT;
+    residual -= detents * ENCODER_COUNTS_PER_DETENT;
+
+    /* Geschwindigkeit in Rastungen/s: delta je ms * 1000, gefiltert */
+    int32_t inst = (int32_t)delta * 1000 / ENCODER_COUNTS_PER_DETENT;
+    if (inst < 0) inst = -inst;
+    vel_filt += inst - (vel_filt >> ENCODER_VEL_SHIFT);
+    uint32_t velocity = (uint32_t)vel_filt >> ENCODER_VEL_SHIFT;
+
+    stats.counts += delta;
+    stats.velocity = velocity;
+    if (velocity > stats.velocity_max) stats.velocity_max = velocity;
+
+    if (detents == 0) {
+        if (residual == 0) edge_valid = 0;   // zurück auf die Rastung
+        return;
+    }
+
+    uint32_t factor = accel_factor(velocity);
+    int32_t steps = detents * (int32_t)factor;
+
+    stats.detents += detents;
+    stats.steps += steps;
+    stats.multiplier = factor;
+
+    trace_input(TRACE_SRC_ENCODER, edge_cycles);
+    edge_valid = (residual != 0);
+
+    /* Aufteilung auf int8-Reports übernimmt xhc_usb_sof */
+    xhc_add_wheel(steps);
+}
+
+/**
+ * @brief Liefert die Statistik (Kopie)
+ */
+void encoder_get_stats(encoder_stats_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(out, &stats, sizeof(stats));
+    __set_PRIMASK(primask);
+}
@@ -62,10 +62,16 @@ void MX_GPIO_Init(void)
   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
   HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
-  /*Configure GPIO pins : Rot_A_Pin Rot_S_Pin Rot_F_Pin Col1_Pin
-                           Col2_Pin Col3_Pin Col4_Pin */
-  GPIO_InitStruct.Pin = Rot_A_Pin|Rot_S_Pin|Rot_F_Pin|Col1_Pin
-                          |Col2_Pin|Col3_Pin|Col4_Pin;
+  /*Configure GPIO pins : Rot_A_Pin Rot_F_Pin */
+  GPIO_InitStruct.Pin = Rot_A_Pin|Rot_F_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
+  GPIO_InitStruct.Pull = GPIO_PULLUP;
+  HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+  /*Configure GPIO pins : Rot_S_Pin Col1_Pin Col2_Pin Col3_Pin
+                           Col4_Pin */
+  GPIO_InitStruct.Pin = Rot_S_Pin|Col1_Pin|Col2_Pin|Col3_Pin
+                          |Col4_Pin;
   GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
   GPIO_InitStruct.Pull = GPIO_PULLUP;
   HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
@@ -79,10 +85,20 @@ void MX_GPIO_Init(void)
 
   /*Configure GPIO pins : Rot_X_Pin Rot_Y_Pin Rot_Z_Pin */
   GPIO_InitStruct.Pin = Rot_X_Pin|Rot_Y_Pin|Rot_Z_Pin;
-  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
   GPIO_InitStruct.Pull = GPIO_PULLUP;
   HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
+  /* EXTI interrupt init*/
+  HAL_NVIC_SetPriority(EXTI1_IRQn, 3, 0);
+  HAL_NVIC_EnableIRQ(EXTI1_IRQn);
+
+  HAL_NVIC_SetPriority(EXTI9_5_IRQn, 3, 0);
+  HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+
+  HAL_NVIC_SetPriority(EXTI15_10_IRQn, 3, 0);
+  HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+
 }
 
 /* USER CODE BEGIN 2 */
@@ -0,0 +1,66 @@
+/*
+ * idle.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Leerlauf: WFI mit Zeitmessung und Aufwachlatenz
+ */
+
+#include "idle.h"
+#include <string.h>
+
+idle_stats_t      idle_stats;
+volatile uint8_t  idle_woken = 0;
+uint32_t          idle_wake_cycles = 0;
+
+static uint32_t sleep_cycles = 0;   // Schlafzyklen gesamt
+static uint32_t dma_cycles = 0;     // Rest unter 1 ms für dma_sleep_ms
+
+/**
+ * @brief Schläft bis zum nächsten Interrupt und lässt dessen ISR laufen
+ * @param site Aufrufer, nur für die Statistik
+ *
+ * Aufruf mit gesperrten IRQs (nach der Prüfung der Wartebedingung).
+ */
+void idle_sleep(idle_site_t site) {
+    uint32_t t0 = dwt_cycles();
+    __WFI();
+    uint32_t t1 = dwt_cycles();
+    uint32_t slept = t1 - t0;
+
+    sleep_cycles += slept;
+    if (site == IDLE_SITE_DMA) {
+        uint32_t ms_cycles = SystemCoreClock / 1000U;
+        idle_stats.dma_sleeps++;
+        dma_cycles += slept;
+        while (dma_cycles >= ms_cycles) {
+            dma_cycles -= ms_cycles;
+            idle_stats.dma_sleep_ms++;
+        }
+    }
+
+    /* Wecker-ISR läuft jetzt; alles nach CPSIE ist in ihrer Latenz enthalten */
+    idle_wake_cycles = t1;
+    idle_woken = 1;
+    __enable_irq();
+    __ISB();
+    idle_woken = 0;   // Weckquelle ohne idle_isr() (z. B. PendSV)
+    __disable_irq();
+}
+
+/**
+ * @brief Schlafzyklen seit Boot (Differenzen über den Überlauf hinweg gültig)
+ */
+uint32_t idle_cycles(void) {
+    return sleep_cycles;
+}
+
+/**
+ * @brief Liefert die Statistik (Kopie)
+ */
+void idle_get_stats(idle_stats_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(out, &idle_stats, sizeof(idle_stats));
+    __set_PRIMASK(primask);
+}
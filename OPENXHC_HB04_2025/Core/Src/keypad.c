@@ -0,0 +1,242 @@
+/*
+ * keypad.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      4x4 Tastenmatrix, Scan per TIM4 + DMA ohne CPU-Last
+ *
+ *  TIM4 zählt mit 1 MHz, ein Überlauf = ein Zeitschlitz je Zeile.
+ *   - Update -> DMA1_Ch7: nächstes Zeilenmuster nach GPIOB->BSRR
+ *   - CC1    -> DMA1_Ch1: GPIOB->IDR in den Snapshot-Ring (nach KEYPAD_SETTLE_US)
+ *  Beide Kanäle laufen zirkular ohne Interrupts. Snapshot i gehört damit
+ *  immer zu Zeile i % 4. keypad_poll() entprellt jede Millisekunde alle
+ *  inzwischen fertigen Scans (debounce.c).
+ *
+ *  CH1 wird nur als DMA-Trigger benutzt (Ausgang bleibt aus), PB6 = Col2
+ *  bleibt normaler Eingang.
+ */
+
+#include "keypad.h"
+#include "main.h"
+#include "xhc_integration.h"
+#include "debounce.h"
+#include "dwt.h"
+#include "trace.h"
+#include <string.h>
+
+#define ROW_MASK  (Row1_Pin | Row2_Pin | Row3_Pin | Row4_Pin)
+#define COL_SHIFT 5   // Col1..Col4 = PB5..PB8
+#define SNAP_LEN  (KEYPAD_ROWS * KEYPAD_SNAP_SCANS)
+
+_Static_assert(Col1_Pin == (1U << COL_SHIFT) && Col4_Pin == (1U << (COL_SHIFT + 3)),
+               "Spalten müssen zusammenhängend ab PB5 liegen");
+
+/* Open-Drain: aktive Zeile auf Low (BR), übrige freigeben (BS) */
+#define ROW_ACTIVE(pin)  ((uint32_t)(ROW_MASK & ~(pin)) | ((uint32_t)(pin) << 16))
+
+/* Eintrag k wird am Ende von Schlitz k geschrieben und gilt für Schlitz k+1;
+ * Zeile 1 wird vor dem Start direkt gesetzt */
+static const uint32_t row_pattern[KEYPAD_ROWS] = {
+    ROW_ACTIVE(Row2_Pin), ROW_ACTIVE(Row3_Pin), ROW_ACTIVE(Row4_Pin), ROW_ACTIVE(Row1_Pin)
+};
+
+static volatile uint16_t col_snap[SNAP_LEN];
+
+/* Tastencodes für den Input-Report (Zeile*4 + Spalte), Zuordnung zu
+ * Funktionen in der xhc-hb04 Konfiguration auf dem Host */
+static const uint8_t key_codes[KEYPAD_KEYS] = {
+    0x01, 0x02, 0x03, 0x04,
+    0x05, 0x06, 0x07, 0x08,
+    0x09, 0x0A, 0x0B, 0x0C,
+    0x0D, 0x0E, 0x0F, 0x10
+};
+
+static debounce_t     deb;
+static uint32_t       next_scan = 0;    // erster noch nicht entprellter Scan
+static volatile uint8_t running = 0;
+static uint32_t       edge_cycles = 0;  // DWT: erster Scan mit Abweichung vom stabilen Zustand
+static uint8_t        edge_valid = 0;
+static keypad_stats_t stats;
+
+static TIM_HandleTypeDef htim4;
+static DMA_HandleTypeDef hdma_kp_row;
+static DMA_HandleTypeDef hdma_kp_col;
+
+/* Zeile 1 aktiv, dann beide Kanäle vor dem Timer starten */
+static void scan_start(void) {
+    Row1_GPIO_Port->BSRR = ROW_ACTIVE(Row1_Pin);
+
+    HAL_DMA_Start(&hdma_kp_row, (uint32_t)row_pattern, (uint32_t)&GPIOB->BSRR, KEYPAD_ROWS);
+    HAL_DMA_Start(&hdma_kp_col, (uint32_t)&GPIOB->IDR, (uint32_t)col_snap, SNAP_LEN);
+
+    __HAL_TIM_SET_COUNTER(&htim4, 0);
+    __HAL_TIM_ENABLE_DMA(&htim4, TIM_DMA_UPDATE | TIM_DMA_CC1);
+    __HAL_TIM_ENABLE(&htim4);
+
+    next_scan = 0;
+    edge_valid = 0;
+    running = 1;
+}
+
+/**
+ * @brief Startet Timer und beide DMA-Kanäle (nach MX_GPIO_Init / MX_DMA_Init)
+ */
+void keypad_init(void) {
+    TIM_OC_InitTypeDef sConfigOC = {0};
+
+    __HAL_RCC_TIM4_CLK_ENABLE();
+
+    /* Zeilenmuster -> BSRR (32 Bit) */
+    hdma_kp_row.Instance = DMA1_Channel7;
+    hdma_kp_row.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_kp_row.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_kp_row.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_kp_row.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    hdma_kp_row.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    hdma_kp_row.Init.Mode = DMA_CIRCULAR;
+    hdma_kp_row.Init.Priority = DMA_PRIORITY_MEDIUM;
+    if (HAL_DMA_Init(&hdma_kp_row) != HAL_OK) Error_Handler();
+
+    /* IDR -> Snapshot-Ring (16 Bit) */
+    hdma_kp_col.Instance = DMA1_Channel1;
+    hdma_kp_col.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_kp_col.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_kp_col.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_kp_col.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_kp_col.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_kp_col.Init.Mode = DMA_CIRCULAR;
+    hdma_kp_col.Init.Priority = DMA_PRIORITY_MEDIUM;
+    if (HAL_DMA_Init(&hdma_kp_col) != HAL_OK) Error_Handler();
+
+    /* TIM4 an APB1 x2 = 72 MHz -> 1 MHz Zähltakt */
+    htim4.Instance = TIM4;
+    htim4.Init.Prescaler = (SystemCoreClock / 1000000U) - 1;
+    htim4.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htim4.Init.Period = KEYPAD_SLOT_US - 1;
+    htim4.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    htim4.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+    if (HAL_TIM_Base_Init(&htim4) != HAL_OK) Error_Handler();
+
+    sConfigOC.OCMode = TIM_OCMODE_TIMING;
+    sConfigOC.Pulse = KEYPAD_SETTLE_US;
+    sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+    sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+    if (HAL_TIM_OC_ConfigChannel(&htim4, &sConfigOC, TIM_CHANNEL_1) != HAL_OK) Error_Handler();
+
+    debounce_init(&deb);
+    scan_start();
+}
+
+/**
+ * @brief Hält den Scan an und zieht alle Zeilen auf Low (USB-Suspend):
+ *        jede gedrückte Taste zieht dann ihre Spalte herunter (EXTI, power.c)
+ */
+void keypad_suspend(void) {
+    running = 0;
+    __HAL_TIM_DISABLE(&htim4);
+    __HAL_TIM_DISABLE_DMA(&htim4, TIM_DMA_UPDATE | TIM_DMA_CC1);
+    HAL_DMA_Abort(&hdma_kp_row);
+    HAL_DMA_Abort(&hdma_kp_col);
+
+    Row1_GPIO_Port->BSRR = (uint32_t)ROW_MASK << 16;
+}
+
+/**
+ * @brief Startet den Scan nach keypad_suspend() neu; der entprellte Zustand bleibt
+ */
+void keypad_resume(void) {
+    scan_start();
+}
+
+/* Index des Scans, den der DMA gerade schreibt */
+static inline uint32_t current_scan(void) {
+    return (SNAP_LEN - __HAL_DMA_GET_COUNTER(&hdma_kp_col)) / KEYPAD_ROWS % KEYPAD_SNAP_SCANS;
+}
+
+/* Scan aus dem Snapshot-Ring in Tastenbits umrechnen */
+static uint16_t scan_keys(uint32_t scan) {
+    const volatile uint16_t *snap = &col_snap[scan * KEYPAD_ROWS];
+    uint16_t keys = 0;
+
+    for (uint32_t r = 0; r < KEYPAD_ROWS; r++) {
+        /* Pull-ups: gedrückt = Low */
+        uint16_t cols = (uint16_t)(~snap[r] >> COL_SHIFT) & 0x0F;
+        keys |= (uint16_t)(cols << (r * KEYPAD_COLS));
+    }
+    return keys;
+}
+
+/**
+ * @brief Liefert den letzten vollständigen Matrix-Scan (ohne Entprellung)
+ */
+uint16_t keypad_read_raw(void) {
+    return scan_keys((current_scan() + KEYPAD_SNAP_SCANS - 1) % KEYPAD_SNAP_SCANS);
+}
+
+/**
+ * @brief Entprellt alle seit dem letzten Aufruf fertigen Scans (5 je ms)
+ *        und übergibt bis zu zwei gedrückte Tasten an den Input-Report
+ */
+void keypad_poll(void) {
+    if (!running) return;
+
+    uint32_t t0 = dwt_cycles();
+    uint32_t cur = current_scan();
+    uint32_t state = deb.stable;
+    uint32_t changed = 0;
+
+    while (next_scan != cur) {
+        uint32_t press, release;
+        uint32_t raw = scan_keys(next_scan);
+
+        if (raw == deb.stable) {
+            edge_valid = 0;   // Prellen ohne Zustandswechsel
+        } else if (!edge_valid) {
+            /* Scanzeitpunkt aus dem Alter im Ring zurückrechnen */
+            uint32_t age = (cur + KEYPAD_SNAP_SCANS - next_scan) % KEYPAD_SNAP_SCANS;
+            edge_cycles = t0 - age * KEYPAD_ROWS * KEYPAD_SLOT_US * (SystemCoreClock / 1000000U);
+            edge_valid = 1;
+        }
+
+        state = debounce_sample(&deb, raw, &press, &release);
+        stats.samples++;
+        stats.presses += (uint32_t)__builtin_popcount(press);
+        stats.releases += (uint32_t)__builtin_popcount(release);
+        changed |= press | release;
+        next_scan = (next_scan + 1) % KEYPAD_SNAP_SCANS;
+    }
+
+    if (changed) {
+        uint8_t btn[2] = {0, 0};
+        uint8_t n = 0;
+
+        for (uint8_t i = 0; i < KEYPAD_KEYS && n < 2; i++) {
+            if (state & (1U << i)) btn[n++] = key_codes[i];
+        }
+        if (edge_valid) {
+            trace_input(TRACE_SRC_KEYPAD, edge_cycles);
+            edge_valid = 0;
+        }
+        xhc_set_buttons(btn[0], btn[1]);
+    }
+
+    stats.poll_cycles_last = dwt_cycles() - t0;
+    if (stats.poll_cycles_last > stats.poll_cycles_max) stats.poll_cycles_max = stats.poll_cycles_last;
+}
+
+/**
+ * @brief Entprellter Tastenzustand
+ */
+uint16_t keypad_get_state(void) {
+    return (uint16_t)deb.stable;
+}
+
+/**
+ * @brief Liefert die Statistik (Kopie)
+ */
+void keypad_get_stats(keypad_stats_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(out, &stats, sizeof(stats));
+    __set_PRIMASK(primask);
+}
@@ -30,6 +30,16 @@
 #include "fonts.h"
 #include "ui.h"
 #include "xhc_integration.h"
+#include "dwt.h"
+#include "keypad.h"
+#include "selector.h"
+#include "encoder.h"
+#include "sched.h"
+#include "telemetry.h"
+#include "power.h"
+#include "settings.h"
+#include "memstat.h"
+#include "prof.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -72,7 +82,7 @@ int main(void)
 {
 
   /* USER CODE BEGIN 1 */
-
+  memstat_paint();     // freien RAM bemalen, bevor irgendetwas den Stack nutzt
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -88,7 +98,7 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
-
+  dwt_init();
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
@@ -98,9 +108,13 @@ int main(void)
   MX_USB_DEVICE_Init();
   MX_TIM2_Init();
   /* USER CODE BEGIN 2 */
-  ST7735_Init();
-  xhc_init();
-  UI_DrawStatic();
+  settings_init();     // vor allen Nutzern der Einstellungen
+  xhc_init();          // startet auch die Display-Init im Scheduler (nicht blockierend)
+  keypad_init();
+  selector_init();
+  encoder_init();
+  telemetry_init();
+  power_init();
 
   // Farbflächen zum schnellen Check
   //ST7735_FillScreen(ST7735_WHITE);
@@ -111,9 +125,12 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-	  xhc_main_loop();
-
-	    // neue Position berechnen
+	  PROF_BEGIN(PROF_ZONE_MAIN_LOOP);
+	  sched_run();
+	  power_poll();
+	  settings_poll(xhc_rx_idle_ms() >= SETTINGS_BUS_IDLE_MS);
+	  memstat_poll();
+	  PROF_END(PROF_ZONE_MAIN_LOOP);
 
     /* USER CODE END WHILE */
 
@@ -0,0 +1,78 @@
+/*
+ * memstat.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      RAM-Reserve: Stack-Hochwassermarke, Heap-Nutzung, Eintrittstiefe je Interrupt-Ebene
+ */
+
+#include "memstat.h"
+#include <string.h>
+
+#define PAINT_MARGIN  64U   // Abstand zum aktuellen SP beim Bemalen (eigener Frame)
+
+extern uint8_t _sdata, _end, _sramfunc, _eramfunc;
+extern uint32_t _Min_Stack_Size;
+
+uint32_t memstat_isr_entry[MEMSTAT_LVL_COUNT];
+
+static uint32_t *paint_top = NULL;   // erstes nicht bemaltes Wort
+static uint32_t *low_mark = NULL;    // tiefstes vom Stack beschriebenes Wort
+static uint32_t  scan_tick = 0;
+
+static uint32_t *heap_end(void) {
+    uint32_t used, peak, fails;
+    sysmem_get_heap(&used, &peak, &fails);
+    uintptr_t p = ((uintptr_t)&_end + peak + 3U) & ~(uintptr_t)3U;
+    return (uint32_t*)p;
+}
+
+/**
+ * @brief Bemalt den freien RAM unterhalb des Stacks (einmal beim Boot)
+ */
+void memstat_paint(void) {
+    uint32_t *p = (uint32_t*)(((uintptr_t)&_end + 3U) & ~(uintptr_t)3U);
+    paint_top = (uint32_t*)((__get_MSP() - PAINT_MARGIN) & ~3U);
+
+    while (p < paint_top) *p++ = MEMSTAT_PATTERN;
+    low_mark = paint_top;
+}
+
+/**
+ * @brief Sucht die Hochwassermarke (alle MEMSTAT_SCAN_MS, Hauptschleife)
+ */
+void memstat_poll(void) {
+    uint32_t now = HAL_GetTick();
+    if ((now - scan_tick) < MEMSTAT_SCAN_MS || !paint_top) return;
+    scan_tick = now;
+
+    /* Von unten bis zur bisherigen Marke: das erste überschriebene Wort zählt,
+       auch wenn darüber noch Muster liegt (ungenutzte lokale Puffer) */
+    uint32_t *p = heap_end();
+    while (p < low_mark && *p == MEMSTAT_PATTERN) p++;
+    if (p < low_mark) low_mark = p;
+}
+
+/**
+ * @brief Liefert die Statistik (Kopie)
+ */
+void memstat_get_stats(memstat_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+
+    out->ram_static = (uint32_t)(&_end - &_sdata);
+    out->ramfunc = (uint32_t)(&_eramfunc - &_sramfunc);
+    sysmem_get_heap(&out->heap_used, &out->heap_peak, &out->heap_fails);
+    out->stack_reserved = (uint32_t)&_Min_Stack_Size;
+
+    uint32_t *low = low_mark;
+    if (low) {
+        uint32_t *heap = heap_end();
+        out->stack_peak = (uint32_t)((uint8_t*)&_estack - (uint8_t*)low);
+        out->stack_free = (low > heap) ? (uint32_t)((uint8_t*)low - (uint8_t*)heap) : 0;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(out->isr_entry_depth, memstat_isr_entry, sizeof(out->isr_entry_depth));
+    __set_PRIMASK(primask);
+}
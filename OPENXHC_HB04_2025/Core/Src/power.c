@@ -0,0 +1,283 @@
+/*
+ * power.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      USB-Suspend: Anzeige aus, STOP-Modus, Aufwachen per Resume oder Eingabe
+ *
+ *  Ablauf:
+ *   - Suspend (USB-IRQ): nur Flag setzen
+ *   - power_poll(): Display in Sleep-In, Tastenscan anhalten (alle Zeilen
+ *     auf Low), Weck-EXTIs freigeben, STOP bis zum nächsten EXTI. Danach
+ *     PLL wiederherstellen, bevor die ISRs laufen.
+ *   - Resume/Reset durch den Host: ISR löscht das Flag, der Input-Report
+ *     mit dem aktuellen Zustand geht im ersten SOF raus.
+ *   - Eingabe: Remote Wakeup, wenn der Host es per SET_FEATURE erlaubt hat,
+ *     sonst wieder schlafen.
+ *
+ *  Handrad-Schritte aus dem Suspend gehen nur nach einem Remote Wakeup des
+ *  Pendants an den Host; weckt der Host selbst, werden sie verworfen.
+ *
+ *  Gemessen wird erster SOF nach Resume -> erster IN-Report abgeholt. Die
+ *  Resume-Signalisierung des Hosts davor (>= 20 ms) liegt außerhalb der Firmware.
+ */
+
+#include "power.h"
+#include "main.h"
+#include "irq_prio.h"
+#include "dwt.h"
+#include "sched.h"
+#include "keypad.h"
+#include "st7735.h"
+#include "xhc_integration.h"
+#include "usbd_core.h"
+#include <string.h>
+
+/* Weck-EXTIs, die nur während des Suspend aktiv sind (Wahlschalter sind immer aktiv) */
+#define WAKE_KEYPAD_LINES  (Col1_Pin | Col2_Pin | Col3_Pin)   // PB5..PB7, fallende Flanke
+#define WAKE_ENCODER_LINE  ENC_A_Pin                          // PA15, beide Flanken
+#define WAKE_LINES         (WAKE_KEYPAD_LINES | WAKE_ENCODER_LINE)
+
+enum { MEAS_IDLE = 0, MEAS_WAIT_SOF, MEAS_WAIT_IN };
+
+/* Nach STOP: Zeitlimit je Takt-Schritt und Versuche, bevor neu gestartet wird */
+#define CLOCK_TIMEOUT_CYCLES  (HSE_STARTUP_TIMEOUT * (HSI_VALUE / 1000U))   // Kern läuft auf HSI
+#define CLOCK_ATTEMPTS        3
+
+extern USBD_HandleTypeDef hUsbDeviceFS;
+
+static volatile uint8_t  suspended = 0;
+static volatile uint8_t  input_wake = 0;   // Eingabe-EXTI während Suspend
+static volatile uint8_t  usb_wake = 0;     // USB-Wakeup-EXTI, Resume/Reset steht aus
+static volatile uint8_t  meas = MEAS_IDLE;
+static uint32_t          suspend_tick = 0;
+static volatile uint32_t usb_wake_tick = 0;
+static uint32_t          sof_cycles = 0;
+static power_stats_t     stats;
+
+/**
+ * @brief USB-Wakeup-EXTI (Leitung 18) vorbereiten (nach MX_USB_DEVICE_Init)
+ */
+void power_init(void) {
+    __HAL_USB_WAKEUP_EXTI_CLEAR_FLAG();
+    __HAL_USB_WAKEUP_EXTI_ENABLE_RISING_EDGE();
+    HAL_NVIC_SetPriority(USBWakeUp_IRQn, IRQ_PRIO_USB, 0);
+    HAL_NVIC_EnableIRQ(USBWakeUp_IRQn);
+}
+
+/* Tastenspalten und Handrad auf EXTI legen (EXTI5..7 -> Port B, EXTI15 -> Port A) */
+static void wake_exti_enable(void) {
+    AFIO->EXTICR[1] = (AFIO->EXTICR[1] & ~(AFIO_EXTICR2_EXTI5 | AFIO_EXTICR2_EXTI6 | AFIO_EXTICR2_EXTI7))
+                    | AFIO_EXTICR2_EXTI5_PB | AFIO_EXTICR2_EXTI6_PB | AFIO_EXTICR2_EXTI7_PB;
+    AFIO->EXTICR[3] = (AFIO->EXTICR[3] & ~AFIO_EXTICR4_EXTI15) | AFIO_EXTICR4_EXTI15_PA;
+
+    EXTI->RTSR = (EXTI->RTSR & ~WAKE_KEYPAD_LINES) | WAKE_ENCODER_LINE;
+    EXTI->FTSR |= WAKE_LINES;
+    EXTI->PR = WAKE_LINES;
+    EXTI->IMR |= WAKE_LINES;
+
+    __HAL_USB_WAKEUP_EXTI_CLEAR_FLAG();
+    __HAL_USB_WAKEUP_EXTI_ENABLE_IT();
+}
+
+static void wake_exti_disable(void) {
+    EXTI->IMR &= ~WAKE_LINES;
+    EXTI->RTSR &= ~WAKE_LINES;
+    EXTI->FTSR &= ~WAKE_LINES;
+    EXTI->PR = WAKE_LINES;
+
+    __HAL_USB_WAKEUP_EXTI_DISABLE_IT();
+    __HAL_USB_WAKEUP_EXTI_CLEAR_FLAG();
+}
+
+/* Resume übernehmen (IRQs gesperrt oder USB-IRQ)
+ * @param remote 1 = Remote Wakeup durch das Pendant, Handrad-Schritte gelten */
+static void resumed(uint8_t remote) {
+    if (!suspended) return;
+    suspended = 0;
+    stats.resumes++;
+    meas = MEAS_WAIT_SOF;
+    xhc_usb_resume(remote);
+}
+
+/* Remote Wakeup: Suspend-Modus der Zelle verlassen, dann 1..15 ms Resume signalisieren */
+static void remote_wakeup(void) {
+    PCD_HandleTypeDef *hpcd = (PCD_HandleTypeDef*)hUsbDeviceFS.pData;
+
+    if (!hUsbDeviceFS.dev_remote_wakeup || hUsbDeviceFS.dev_old_state != USBD_STATE_CONFIGURED) {
+        stats.wakes_ignored++;
+        return;
+    }
+    while ((HAL_GetTick() - suspend_tick) < POWER_RWU_IDLE_MS) {
+        __WFI();
+    }
+
+    hpcd->Instance->CNTR &= (uint16_t)~(USB_CNTR_LP_MODE | USB_CNTR_FSUSP);
+    HAL_PCD_ActivateRemoteWakeup(hpcd);
+    HAL_Delay(POWER_RWU_SIGNAL_MS);
+    HAL_PCD_DeActivateRemoteWakeup(hpcd);
+
+    __disable_irq();
+    if (suspended) {
+        stats.remote_wakeups++;
+        USBD_LL_Resume(&hUsbDeviceFS);
+        resumed(1);
+    }
+    __enable_irq();
+}
+
+/* Wartet mit Zeitlimit über DWT: SysTick steht, die HAL-Timeouts liefen nie ab */
+static uint8_t clock_wait(volatile uint32_t *reg, uint32_t mask, uint32_t value) {
+    uint32_t t0 = dwt_cycles();
+    while ((*reg & mask) != value) {
+        if (dwt_cycles() - t0 > CLOCK_TIMEOUT_CYCLES) return 0;
+    }
+    return 1;
+}
+
+/* HSE + PLL neu starten; PLL-Faktoren, Teiler und Flash-Wartezyklen bleiben über STOP erhalten */
+static uint8_t clock_restore(void) {
+    RCC->CR |= RCC_CR_HSEON;
+    if (!clock_wait(&RCC->CR, RCC_CR_HSERDY, RCC_CR_HSERDY)) return 0;
+    RCC->CR |= RCC_CR_PLLON;
+    if (!clock_wait(&RCC->CR, RCC_CR_PLLRDY, RCC_CR_PLLRDY)) return 0;
+    RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_PLL;
+    return clock_wait(&RCC->CFGR, RCC_CFGR_SWS, RCC_CFGR_SWS_PLL);
+}
+
+/* STOP bis zum nächsten EXTI, danach Takt wiederherstellen (IRQs gesperrt) */
+static void enter_stop(void) {
+    stats.stop_entries++;
+    HAL_SuspendTick();
+    HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+
+    /* Nach STOP läuft der Kern auf HSI 8 MHz. Ohne HSE kein USB-Takt: nach
+     * mehreren Fehlversuchen neu starten statt auf HSI weiterzulaufen */
+    uint8_t ok = 0;
+    for (uint8_t i = 0; i < CLOCK_ATTEMPTS && !ok; i++) {
+        ok = clock_restore();
+        if (!ok) {
+            stats.clock_failures++;
+            RCC->CR &= ~(RCC_CR_PLLON | RCC_CR_HSEON);
+        }
+    }
+    if (!ok) NVIC_SystemReset();
+    HAL_ResumeTick();
+}
+
+/**
+ * @brief Schaltet bei Suspend ab und kehrt erst nach Resume zurück
+ */
+void power_poll(void) {
+    if (!suspended) return;
+
+    ST7735_Sleep(true);
+    keypad_suspend();
+    wake_exti_enable();
+
+    while (suspended) {
+        __disable_irq();
+        if (suspended && !input_wake) {
+            if (usb_wake && (HAL_GetTick() - usb_wake_tick) < POWER_WAKE_TIMEOUT_MS) {
+                /* Bus aktiv, der USB-IRQ meldet gleich Resume oder Reset: nur Sleep */
+                __WFI();
+            } else {
+                usb_wake = 0;
+                enter_stop();
+            }
+        }
+        __enable_irq();   // ausstehende ISRs laufen jetzt mit vollem Takt
+
+        if (input_wake) {
+            input_wake = 0;
+            if (suspended) remote_wakeup();
+        }
+    }
+
+    wake_exti_disable();
+    keypad_resume();
+    ST7735_Sleep(false);
+    sched_signal(SCHED_EV_DISPLAY);
+}
+
+/**
+ * @brief Host hat den Bus in Suspend versetzt (USB-IRQ)
+ */
+void power_usb_suspend(void) {
+    if (suspended) return;
+    suspended = 1;
+    input_wake = 0;
+    meas = MEAS_IDLE;
+    suspend_tick = HAL_GetTick();
+    stats.suspends++;
+}
+
+/**
+ * @brief Resume durch den Host (USB-IRQ)
+ */
+void power_usb_resume(void) {
+    usb_wake = 0;
+    resumed(0);
+}
+
+/**
+ * @brief Bus-Reset beendet den Suspend ebenfalls (USB-IRQ)
+ */
+void power_usb_reset(void) {
+    usb_wake = 0;
+    suspended = 0;
+    meas = MEAS_IDLE;
+}
+
+/**
+ * @brief SOF (USB-IRQ): Startpunkt der Resume-Messung
+ */
+void power_usb_sof(void) {
+    if (meas != MEAS_WAIT_SOF) return;
+    sof_cycles = dwt_cycles();
+    meas = MEAS_WAIT_IN;
+}
+
+/**
+ * @brief IN-Report abgeholt (USB-IRQ): Ende der Resume-Messung
+ */
+void power_in_complete(void) {
+    if (meas != MEAS_WAIT_IN) return;
+    meas = MEAS_IDLE;
+    stats.resume_us_last = dwt_to_us(dwt_cycles() - sof_cycles);
+    if (stats.resume_us_last > stats.resume_us_max) stats.resume_us_max = stats.resume_us_last;
+}
+
+/**
+ * @brief EXTI der Eingabe (IRQ): eigene Weckleitungen quittieren, Wakeup vormerken
+ */
+void power_exti_wake(void) {
+    uint32_t pr = EXTI->PR & WAKE_LINES;
+    if (pr) EXTI->PR = pr;
+    if (suspended) input_wake = 1;
+}
+
+/**
+ * @brief USB-Wakeup-EXTI (IRQ)
+ */
+void power_usb_wakeup_irq(void) {
+    __HAL_USB_WAKEUP_EXTI_CLEAR_FLAG();
+    if (suspended) {
+        usb_wake_tick = HAL_GetTick();
+        usb_wake = 1;
+    }
+}
+
+uint8_t power_is_suspended(void) {
+    return suspended;
+}
+
+/**
+ * @brief Liefert die Statistik (Kopie)
+ */
+void power_get_stats(power_stats_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(out, &stats, sizeof(stats));
+    __set_PRIMASK(primask);
+}
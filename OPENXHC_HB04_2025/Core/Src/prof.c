@@ -0,0 +1,92 @@
+/*
+ * prof.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Profiling-Zonen mit DWT CYCCNT: Statistik je Zone + Ringpuffer der letzten Ereignisse
+ */
+
+#include "prof.h"
+#include <string.h>
+
+#define DUR_MASK  0x00FFFFFFu
+
+_Static_assert((PROF_RING_SIZE & (PROF_RING_SIZE - 1)) == 0, "PROF_RING_SIZE muss eine Zweierpotenz sein");
+
+typedef struct {
+    uint32_t start;
+    uint32_t zone_dur;   // Zone << 24 | Dauer
+} prof_event_t;
+
+static prof_zone_stats_t zones[PROF_ZONE_COUNT];
+static prof_event_t      ring[PROF_RING_SIZE];
+static uint32_t          ring_head = 0, ring_tail = 0;
+static uint32_t          ring_dropped = 0;
+
+#if PROF_ENABLE
+/**
+ * @brief Schließt eine Zone ab (jeder Kontext, ~30 Zyklen mit gesperrten IRQs)
+ */
+void prof_record(prof_zone_t zone, uint32_t start_cycles) {
+    uint32_t dur = dwt_cycles() - start_cycles;
+    prof_zone_stats_t *z = &zones[zone];
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (z->count == 0 || dur < z->min_cycles) z->min_cycles = dur;
+    if (dur > z->max_cycles) z->max_cycles = dur;
+    z->last_cycles = dur;
+    z->count++;
+    uint32_t lo = z->total_lo + dur;
+    if (lo < z->total_lo) z->total_hi++;
+    z->total_lo = lo;
+
+    prof_event_t *e = &ring[ring_head % PROF_RING_SIZE];
+    e->start = start_cycles;
+    e->zone_dur = (uint32_t)zone << 24 | (dur > DUR_MASK ? DUR_MASK : dur);
+    ring_head++;
+    __set_PRIMASK(primask);
+}
+#endif
+
+/**
+ * @brief Liefert die Statistik einer Zone (Kopie)
+ */
+void prof_get_zone(prof_zone_t zone, prof_zone_stats_t *out) {
+    if ((uint32_t)zone >= PROF_ZONE_COUNT) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = zones[zone];
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Liest die ältesten Ereignisse aus dem Ring und gibt sie frei
+ * @return Anzahl gelieferter Ereignisse
+ */
+uint8_t prof_read_events(uint32_t *dst, uint8_t max, uint32_t *dropped, uint32_t *remaining) {
+    uint8_t n = 0;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (ring_head - ring_tail > PROF_RING_SIZE) {
+        ring_dropped += ring_head - ring_tail - PROF_RING_SIZE;
+        ring_tail = ring_head - PROF_RING_SIZE;
+    }
+    while (n < max && ring_tail != ring_head) {
+        const prof_event_t *e = &ring[ring_tail % PROF_RING_SIZE];
+        dst[2 * n] = e->start;
+        dst[2 * n + 1] = e->zone_dur;
+        ring_tail++;
+        n++;
+    }
+    *dropped = ring_dropped;
+    *remaining = ring_head - ring_tail;
+    ring_dropped = 0;
+    __set_PRIMASK(primask);
+
+    return n;
+}
@@ -0,0 +1,150 @@
+/*
+ * sched.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Kooperativer Scheduler für die Hauptschleife
+ */
+
+#include "sched.h"
+#include "dwt.h"
+#include "idle.h"
+#include <string.h>
+
+typedef struct {
+    sched_fn_t fn;
+    uint32_t   period_ms;    // 0 = nur ereignisgesteuert
+    uint32_t   events;       // Ereignismaske, 0 = nur periodisch
+    uint32_t   budget_cycles;
+    uint32_t   next_tick;    // nächster Fälligkeitszeitpunkt (HAL_GetTick)
+} sched_entry_t;
+
+static sched_entry_t     tasks[SCHED_TASK_COUNT];
+static volatile uint32_t events_pending = 0;
+static sched_stats_t     stats = { .idle_min_permille = 1000 };
+
+static uint32_t idle_start = 0;      // idle_cycles() zu Beginn des Messfensters
+static uint32_t window_start = 0;    // DWT: Beginn des Messfensters
+
+/**
+ * @brief Trägt einen Task ein (vor dem ersten sched_run)
+ * @param period_ms Periode, 0 = nicht periodisch
+ * @param events    Ereignisbits, die den Task starten
+ * @param budget_us erlaubte Laufzeit, 0 = Periode bzw. unbegrenzt
+ */
+void sched_register(sched_task_t task, sched_fn_t fn, uint32_t period_ms,
+                    uint32_t events, uint32_t budget_us) {
+    if (task >= SCHED_TASK_COUNT) return;
+
+    if (budget_us == 0) budget_us = period_ms * 1000U;
+    tasks[task].fn = fn;
+    tasks[task].period_ms = period_ms;
+    tasks[task].events = events;
+    tasks[task].budget_cycles = budget_us * (SystemCoreClock / 1000000U);
+    tasks[task].next_tick = HAL_GetTick() + period_ms;
+}
+
+/**
+ * @brief Setzt Ereignisbits; der Task läuft im nächsten Durchlauf
+ */
+void sched_signal(uint32_t events) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    events_pending |= events;
+    __set_PRIMASK(primask);
+}
+
+/* Ist ein Task fällig? (IRQs gesperrt) */
+static inline uint8_t task_ready(const sched_entry_t *t, uint32_t now, uint32_t ev) {
+    if (!t->fn) return 0;
+    if (t->events & ev) return 1;
+    return t->period_ms && (int32_t)(now - t->next_tick) >= 0;
+}
+
+static void run_task(sched_task_t i, uint32_t now) {
+    sched_entry_t *t = &tasks[i];
+    sched_task_stats_t *s = &stats.task[i];
+
+    if (t->period_ms && (int32_t)(now - t->next_tick) >= 0) {
+        /* Verpasste Perioden nicht nachholen, sondern als Überlauf zählen */
+        t->next_tick += t->period_ms;
+        if ((int32_t)(now - t->next_tick) >= 0) {
+            s->overruns++;
+            t->next_tick = now + t->period_ms;
+        }
+    }
+
+    uint32_t start = dwt_cycles();
+    t->fn();
+    uint32_t run = dwt_cycles() - start;
+
+    s->runs++;
+    s->run_last_us = dwt_to_us(run);
+    if (s->run_last_us > s->run_max_us) s->run_max_us = s->run_last_us;
+    if (t->budget_cycles && run > t->budget_cycles) s->overruns++;
+}
+
+/* Leerlaufanteil je Sekunde, inkl. Schlaf beim Warten auf SPI-DMA */
+static void idle_window(void) {
+    uint32_t now = dwt_cycles();
+    uint32_t span = now - window_start;
+
+    if (span < SystemCoreClock) return;
+
+    uint32_t idle = idle_cycles();
+    uint32_t permille = (uint32_t)(((uint64_t)(idle - idle_start) * 1000U) / span);
+    stats.idle_permille = permille;
+    if (permille < stats.idle_min_permille) stats.idle_min_permille = permille;
+    idle_start = idle;
+    window_start = now;
+}
+
+/**
+ * @brief Ein Durchlauf: alle fälligen Tasks in Prioritätsreihenfolge,
+ *        sonst WFI bis zum nächsten Interrupt
+ */
+void sched_run(void) {
+    uint32_t now = HAL_GetTick();
+    uint8_t ran = 0;
+
+    for (uint32_t i = 0; i < SCHED_TASK_COUNT; i++) {
+        sched_entry_t *t = &tasks[i];
+
+        __disable_irq();
+        uint8_t ready = task_ready(t, now, events_pending);
+        if (ready) events_pending &= ~t->events;
+        __enable_irq();
+
+        if (ready) {
+            run_task((sched_task_t)i, now);
+            ran = 1;
+        }
+    }
+
+    idle_window();
+    if (ran) return;
+
+    /* Prüfen und Schlafen mit gesperrten IRQs: ein Interrupt nach der Prüfung
+     * weckt WFI trotzdem, seine ISR läuft erst nach __enable_irq() */
+    __disable_irq();
+    uint8_t ready = 0;
+    now = HAL_GetTick();
+    for (uint32_t i = 0; i < SCHED_TASK_COUNT; i++) {
+        ready |= task_ready(&tasks[i], now, events_pending);
+    }
+    if (!ready) {
+        idle_sleep(IDLE_SITE_MAIN);
+        stats.wakeups++;
+    }
+    __enable_irq();
+}
+
+/**
+ * @brief Liefert die Scheduler-Statistik (Kopie)
+ */
+void sched_get_stats(sched_stats_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = stats;
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,121 @@
+/*
+ * selector.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Achs-/Funktionswahlschalter per EXTI mit Einschwingfenster
+ *
+ *  Jede Flanke startet das Einschwingfenster neu. Ist der Schalter
+ *  SELECTOR_SETTLE_US ruhig, liest selector_poll() (1 ms) alle Pins und
+ *  meldet die neue Position per xhc_set_wheel_mode(): der IN-Report geht
+ *  im nächsten USB-Frame raus, die Anzeige folgt in xhc_main_loop.
+ *
+ *  EXTI-Leitungen sind pro Nummer nur einem Port zuordenbar:
+ *  EXTI8 gehört Rot_X (PA8, nicht Col4/PB8), EXTI10 gehört Rot_Z (PA10).
+ *  Rot_S (PB10) hat damit keinen Interrupt und wird per Polling erkannt;
+ *  Wechsel von/zu den Nachbarstellungen lösen über deren Pins trotzdem
+ *  eine Flanke aus.
+ */
+
+#include "selector.h"
+#include "main.h"
+#include "xhc_integration.h"
+#include "dwt.h"
+#include "trace.h"
+#include <string.h>
+
+static volatile uint8_t  edge_pending = 0;
+static volatile uint32_t first_edge_cycles = 0;  // erste Flanke seit letzter Übernahme
+static volatile uint32_t last_edge_cycles = 0;
+static uint8_t  position = ROTARY_OFF;    // übernommene Position
+static uint8_t  poll_candidate = ROTARY_OFF;
+static uint32_t poll_candidate_cycles = 0;
+static selector_stats_t stats;
+
+/* Pins -> ROTARY_* (aktive Stellung zieht auf Low) */
+static uint8_t read_position(void) {
+    uint32_t a = GPIOA->IDR;
+    uint32_t b = GPIOB->IDR;
+
+    if (!(a & Rot_X_Pin)) return ROTARY_X;
+    if (!(a & Rot_Y_Pin)) return ROTARY_Y;
+    if (!(a & Rot_Z_Pin)) return ROTARY_Z;
+    if (!(b & Rot_A_Pin)) return ROTARY_A;
+    if (!(b & Rot_S_Pin)) return ROTARY_SPINDLE;
+    if (!(b & Rot_F_Pin)) return ROTARY_FEED;
+    return ROTARY_OFF;
+}
+
+/**
+ * @brief Übernimmt die aktuelle Schalterstellung (nach MX_GPIO_Init)
+ */
+void selector_init(void) {
+    position = read_position();
+    poll_candidate = position;
+    xhc_set_wheel_mode(position);
+}
+
+/**
+ * @brief EXTI-Callback (HAL): nur Zeitstempel, Auswertung in selector_poll
+ */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    if (!(GPIO_Pin & (Rot_X_Pin | Rot_Y_Pin | Rot_Z_Pin | Rot_A_Pin | Rot_F_Pin))) return;
+
+    uint32_t now = dwt_cycles();
+    if (!edge_pending) {
+        first_edge_cycles = now;
+        edge_pending = 1;
+    }
+    last_edge_cycles = now;
+    stats.edges++;
+}
+
+static void apply(uint8_t pos, uint32_t since) {
+    position = pos;
+    poll_candidate = pos;
+    stats.changes++;
+    stats.latency_last_us = dwt_to_us(dwt_cycles() - since);
+    if (stats.latency_last_us > stats.latency_max_us) stats.latency_max_us = stats.latency_last_us;
+    trace_input(TRACE_SRC_SELECTOR, since);
+    xhc_set_wheel_mode(pos);
+}
+
+/**
+ * @brief Wertet abgeschlossene Flanken aus; ohne Flanke Polling-Rückfallebene
+ */
+void selector_poll(void) {
+    if (edge_pending) {
+        if (dwt_to_us(dwt_cycles() - last_edge_cycles) < SELECTOR_SETTLE_US) return;
+
+        edge_pending = 0;
+        uint8_t pos = read_position();
+        if (pos != position) {
+            apply(pos, first_edge_cycles);
+        } else {
+            stats.glitches++;
+        }
+        return;
+    }
+
+    /* Polling: zwei gleiche Lesungen im Abstand von 1 ms */
+    uint8_t pos = read_position();
+    if (pos == position) {
+        poll_candidate = pos;
+    } else if (pos == poll_candidate) {
+        stats.poll_changes++;
+        apply(pos, poll_candidate_cycles);
+    } else {
+        poll_candidate = pos;
+        poll_candidate_cycles = dwt_cycles();
+    }
+}
+
+/**
+ * @brief Liefert die Statistik (Kopie)
+ */
+void selector_get_stats(selector_stats_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(out, &stats, sizeof(stats));
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,343 @@
+/*
+ * settings.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Einstellungen im Flash: Log aus 8-Byte-Datensätzen in den letzten zwei Seiten
+ *
+ *  Schreibreihenfolge, damit ein Reset mitten im Schreiben nichts Falsches
+ *  hinterlässt:
+ *   - Datensatz: Wert, CRC, zuletzt Schlüssel. Ein abgebrochener Datensatz
+ *     fällt beim Boot durch die CRC und belegt nur seinen Platz.
+ *   - Kompaktierung: Zielseite löschen, Werte kopieren, zuletzt Kopf
+ *     (Sequenznummer, dann Magic). Ohne Magic bleibt die alte Seite gültig.
+ *  Beim Boot gilt die gültige Seite mit der höheren Sequenznummer.
+ *
+ *  Gelöscht wird nur die Reserveseite: vorab in settings_poll() oder, wenn
+ *  sie bei der Kompaktierung noch beschrieben ist, in compact().
+ */
+
+#include "settings.h"
+#include "stm32f1xx_hal.h"
+#include "dwt.h"
+#include "encoder.h"
+#include <string.h>
+
+/* Lesezugriff auf den Flash (Host-Test: emuliertes Array) */
+#ifndef SETTINGS_FLASH_PTR
+#define SETTINGS_FLASH_PTR(addr)  ((const uint8_t*)(uintptr_t)(addr))
+#endif
+
+#define SETTINGS_MAGIC   0x53434858U   // "XHCS"
+#define HDR_SIZE         8U
+#define REC_SIZE         8U
+#define SLOTS_PER_PAGE   ((SETTINGS_PAGE_SIZE - HDR_SIZE) / REC_SIZE)
+#define NO_PAGE          0xFFFFFFFFU
+
+/* Zustand der Reserveseite (Ziel der nächsten Kompaktierung) */
+enum { SPARE_USED = 0, SPARE_BLANK, SPARE_FAILED };
+
+/* Nach einer Kompaktierung muss noch Platz für Änderungen bleiben */
+_Static_assert(SETTINGS_KEY_COUNT <= SLOTS_PER_PAGE / 2, "zu viele Einstellungen für eine Flash-Seite");
+_Static_assert(SETTINGS_KEY_COUNT <= 32, "dirty-Maske hat 32 Bit");
+
+static const uint32_t defaults[SETTINGS_KEY_COUNT] = {
+    [SETTINGS_KEY_ENC_REVERSE]  = 0,
+    [SETTINGS_KEY_ENC_ACCEL]    = ENCODER_ACCEL,
+    [SETTINGS_KEY_DISPLAY_FLIP] = 0,
+};
+
+static volatile uint32_t values[SETTINGS_KEY_COUNT];   // aktueller Stand (RAM)
+static uint32_t          stored[SETTINGS_KEY_COUNT];   // Stand im Flash
+static volatile uint32_t dirty = 0;                    // Bit je Schlüssel: noch nicht geschrieben
+static volatile uint32_t change_tick = 0;
+static uint32_t          active = NO_PAGE;             // aktive Seite
+static uint32_t          write_off = 0;                // nächster freier Datensatz (Offset)
+static settings_stats_t  stats;
+static uint8_t           spare = SPARE_USED;
+
+static uint32_t page_addr(uint32_t page) {
+    return SETTINGS_FLASH_BASE + page * SETTINGS_PAGE_SIZE;
+}
+
+static uint32_t rd32(uint32_t addr) {
+    uint32_t v;
+    memcpy(&v, SETTINGS_FLASH_PTR(addr), sizeof(v));
+    return v;
+}
+
+/* CRC-16/CCITT (0xFFFF) über Schlüssel und Wert, Little Endian */
+static uint16_t record_crc(uint16_t key, uint32_t value) {
+    const uint8_t b[6] = { (uint8_t)key, (uint8_t)(key >> 8),
+                           (uint8_t)value, (uint8_t)(value >> 8),
+                           (uint8_t)(value >> 16), (uint8_t)(value >> 24) };
+    uint16_t crc = 0xFFFF;
+    for (uint32_t i = 0; i < sizeof(b); i++) {
+        crc ^= (uint16_t)b[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint8_t prog16(uint32_t addr, uint16_t v) {
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, addr, v) != HAL_OK) {
+        stats.flash_errors++;
+        return 0;
+    }
+    return 1;
+}
+
+/* Schlüssel zuletzt: erst dann gilt der Datensatz als geschrieben */
+static uint8_t write_record(uint32_t addr, uint16_t key, uint32_t value) {
+    return prog16(addr + 4, (uint16_t)value) &&
+           prog16(addr + 6, (uint16_t)(value >> 16)) &&
+           prog16(addr + 2, record_crc(key, value)) &&
+           prog16(addr, key);
+}
+
+static uint8_t erase_page(uint32_t page) {
+    FLASH_EraseInitTypeDef erase = {
+        .TypeErase   = FLASH_TYPEERASE_PAGES,
+        .PageAddress = page_addr(page),
+        .NbPages     = 1,
+    };
+    uint32_t page_error;
+
+    if (HAL_FLASHEx_Erase(&erase, &page_error) != HAL_OK) {
+        stats.flash_errors++;
+        return 0;
+    }
+    return 1;
+}
+
+static uint32_t spare_page(void) {
+    return (active == 0) ? 1 : 0;
+}
+
+static uint8_t page_blank(uint32_t page) {
+    for (uint32_t off = 0; off < SETTINGS_PAGE_SIZE; off += 4) {
+        if (rd32(page_addr(page) + off) != 0xFFFFFFFFU) return 0;
+    }
+    return 1;
+}
+
+static void update_fill(void) {
+    stats.active_page = active;
+    stats.used_slots = (active == NO_PAGE) ? 0 : (write_off - HDR_SIZE) / REC_SIZE;
+    stats.free_slots = SLOTS_PER_PAGE - stats.used_slots;
+}
+
+/* Aktuelle Werte in die andere Seite kopieren (Flash entsperrt) */
+static uint8_t compact(const uint32_t *snap) {
+    uint32_t t0 = dwt_cycles();
+    uint32_t target = spare_page();
+    uint32_t base = page_addr(target);
+    uint32_t seq = stats.seq + 1;
+    uint32_t off = HDR_SIZE;
+    uint8_t  blank = (spare == SPARE_BLANK);
+
+    spare = SPARE_USED;   // ab hier beschrieben, auch bei Abbruch
+    if (!blank && !erase_page(target)) return 0;
+
+    for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) {
+        if (snap[k] == defaults[k]) continue;   // Vorgabewert braucht keinen Datensatz
+        if (!write_record(base + off, (uint16_t)k, snap[k])) return 0;
+        off += REC_SIZE;
+    }
+
+    /* Kopf zuletzt, Magic als letztes Halbwort */
+    if (!prog16(base + 4, (uint16_t)seq) || !prog16(base + 6, (uint16_t)(seq >> 16)) ||
+        !prog16(base + 2, (uint16_t)(SETTINGS_MAGIC >> 16)) || !prog16(base, (uint16_t)SETTINGS_MAGIC)) {
+        return 0;
+    }
+
+    active = target;
+    write_off = off;
+    memcpy(stored, snap, sizeof(stored));
+    stats.seq = seq;
+    stats.compactions++;
+
+    uint32_t us = dwt_to_us(dwt_cycles() - t0);
+    if (us > stats.erase_us_max) stats.erase_us_max = us;
+    return 1;
+}
+
+/**
+ * @brief Liest das Log der aktiven Seite einmal in die RAM-Tabelle (Boot)
+ */
+void settings_init(void) {
+    uint32_t t0 = dwt_cycles();
+    uint32_t seq[SETTINGS_PAGES];
+    uint8_t  valid[SETTINGS_PAGES];
+
+    memset(&stats, 0, sizeof(stats));
+    memcpy(stored, defaults, sizeof(stored));
+    dirty = 0;
+    active = NO_PAGE;
+    write_off = HDR_SIZE;
+
+    for (uint32_t p = 0; p < SETTINGS_PAGES; p++) {
+        valid[p] = (rd32(page_addr(p)) == SETTINGS_MAGIC);
+        seq[p] = rd32(page_addr(p) + 4);
+    }
+    if (valid[0] && valid[1]) {
+        active = ((int32_t)(seq[1] - seq[0]) > 0) ? 1 : 0;
+    } else if (valid[0] || valid[1]) {
+        active = valid[0] ? 0 : 1;
+    }
+
+    if (active != NO_PAGE) {
+        uint32_t base = page_addr(active);
+        uint32_t off;
+
+        stats.seq = seq[active];
+        for (off = HDR_SIZE; off < SETTINGS_PAGE_SIZE; off += REC_SIZE) {
+            uint32_t w0 = rd32(base + off);
+            uint32_t w1 = rd32(base + off + 4);
+            if (w0 == 0xFFFFFFFFU && w1 == 0xFFFFFFFFU) break;   // Ende des Logs
+
+            uint16_t key = (uint16_t)w0;
+            if (key < SETTINGS_KEY_COUNT && (uint16_t)(w0 >> 16) == record_crc(key, w1)) {
+                stored[key] = w1;
+                stats.loaded++;
+            } else {
+                stats.crc_errors++;
+            }
+        }
+        write_off = off;
+    }
+
+    for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) values[k] = stored[k];
+    spare = page_blank(spare_page()) ? SPARE_BLANK : SPARE_USED;
+    update_fill();
+    stats.scan_us = dwt_to_us(dwt_cycles() - t0);
+}
+
+/**
+ * @brief Aktueller Wert (RAM, jeder Kontext)
+ */
+uint32_t settings_get(settings_key_t key) {
+    return ((uint32_t)key < SETTINGS_KEY_COUNT) ? values[key] : 0;
+}
+
+/**
+ * @brief Ändert einen Wert; geschrieben wird später aus settings_poll()
+ */
+void settings_set(settings_key_t key, uint32_t value) {
+    if ((uint32_t)key >= SETTINGS_KEY_COUNT) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    values[key] = value;
+    dirty |= 1U << key;
+    change_tick = HAL_GetTick();
+    __set_PRIMASK(primask);
+}
+
+/* Reserveseite vorab löschen */
+static void pre_erase(void) {
+    uint32_t t0 = dwt_cycles();
+
+    HAL_FLASH_Unlock();
+    spare = erase_page(spare_page()) ? SPARE_BLANK : SPARE_FAILED;
+    HAL_FLASH_Lock();
+
+    uint32_t us = dwt_to_us(dwt_cycles() - t0);
+    if (us > stats.erase_us_max) stats.erase_us_max = us;
+}
+
+/* Schreibt die vorgemerkten Änderungen */
+static void flush(void);
+
+/**
+ * @brief Hauptschleife: schreibt gesammelt, wenn SETTINGS_FLUSH_DELAY_MS
+ *        lang nichts mehr geändert wurde
+ * @param bus_idle 1 = Host sendet nichts, Flash-Stillstand erlaubt; sonst
+ *        bleibt alles im RAM vorgemerkt
+ */
+void settings_poll(uint8_t bus_idle) {
+    if (!bus_idle) return;
+
+    if (spare == SPARE_USED) {
+        pre_erase();   // ein Versuch je Kompaktierung, ein Stillstand je Aufruf
+        return;
+    }
+
+    if (!dirty) return;
+    if ((HAL_GetTick() - change_tick) < SETTINGS_FLUSH_DELAY_MS) return;
+    flush();
+}
+
+/**
+ * @brief Schreibt alle vorgemerkten Änderungen sofort, notfalls mit Löschen
+ *
+ * Hält den Flash bis zu ~20 ms an: nur ohne USB-Verkehr aufrufen.
+ */
+void settings_flush(void) {
+    flush();
+}
+
+static void flush(void) {
+    uint32_t snap[SETTINGS_KEY_COUNT];
+    uint32_t need = 0, done = 0, n = 0;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) snap[k] = values[k];
+    uint32_t pending = dirty;
+    dirty = 0;
+    __set_PRIMASK(primask);
+
+    for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) {
+        if ((pending & (1U << k)) && snap[k] != stored[k]) {
+            need |= 1U << k;
+            n++;
+        }
+    }
+    if (!need) return;
+
+    uint8_t full = (active == NO_PAGE || write_off + n * REC_SIZE > SETTINGS_PAGE_SIZE);
+
+    HAL_FLASH_Unlock();
+    if (full) {
+        if (compact(snap)) done = need;
+    } else {
+        for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) {
+            if (!(need & (1U << k))) continue;
+
+            uint32_t t0 = dwt_cycles();
+            uint8_t ok = write_record(page_addr(active) + write_off, (uint16_t)k, snap[k]);
+            write_off += REC_SIZE;   // auch ein abgebrochener Datensatz belegt seinen Platz
+            if (!ok) break;
+
+            stored[k] = snap[k];
+            done |= 1U << k;
+            stats.writes++;
+            uint32_t us = dwt_to_us(dwt_cycles() - t0);
+            if (us > stats.write_us_max) stats.write_us_max = us;
+        }
+    }
+    HAL_FLASH_Lock();
+
+    if (done != need) {
+        /* Nächster Versuch nach der Ruhezeit */
+        primask = __get_PRIMASK();
+        __disable_irq();
+        dirty |= need & ~done;
+        change_tick = HAL_GetTick();
+        __set_PRIMASK(primask);
+    }
+    update_fill();
+}
+
+/**
+ * @brief Liefert die Statistik (Kopie)
+ */
+void settings_get_stats(settings_stats_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(out, &stats, sizeof(stats));
+    __set_PRIMASK(primask);
+}
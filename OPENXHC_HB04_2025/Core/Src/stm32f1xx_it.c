@@ -22,6 +22,14 @@
 #include "stm32f1xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "defer.h"
+#include "keypad.h"
+#include "selector.h"
+#include "encoder.h"
+#include "power.h"
+#include "memstat.h"
+#include "prof.h"
+#include "idle.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -171,7 +179,8 @@ void DebugMon_Handler(void)
 void PendSV_Handler(void)
 {
   /* USER CODE BEGIN PendSV_IRQn 0 */
-
+  memstat_isr(MEMSTAT_LVL_DEFER);
+  defer_run();
   /* USER CODE END PendSV_IRQn 0 */
   /* USER CODE BEGIN PendSV_IRQn 1 */
 
@@ -184,10 +193,14 @@ void PendSV_Handler(void)
 void SysTick_Handler(void)
 {
   /* USER CODE BEGIN SysTick_IRQn 0 */
-
+  idle_isr(IDLE_SRC_SYSTICK);
+  memstat_isr(MEMSTAT_LVL_SYSTICK);
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
+  keypad_poll();
+  selector_poll();
+  encoder_poll();
 
   /* USER CODE END SysTick_IRQn 1 */
 }
@@ -199,13 +212,30 @@ void SysTick_Handler(void)
 /* please refer to the startup file (startup_stm32f1xx.s).                    */
 /******************************************************************************/
 
+/**
+  * @brief This function handles EXTI line1 interrupt.
+  */
+void EXTI1_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI1_IRQn 0 */
+  idle_isr(IDLE_SRC_INPUT);
+  memstat_isr(MEMSTAT_LVL_INPUT);
+  power_exti_wake();
+  /* USER CODE END EXTI1_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(Rot_A_Pin);
+  /* USER CODE BEGIN EXTI1_IRQn 1 */
+
+  /* USER CODE END EXTI1_IRQn 1 */
+}
+
 /**
   * @brief This function handles DMA1 channel3 global interrupt.
   */
 void DMA1_Channel3_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel3_IRQn 0 */
-
+  idle_isr(IDLE_SRC_DMA_SPI);
+  memstat_isr(MEMSTAT_LVL_DMA_SPI);
   /* USER CODE END DMA1_Channel3_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_spi1_tx);
   /* USER CODE BEGIN DMA1_Channel3_IRQn 1 */
@@ -219,14 +249,60 @@ void DMA1_Channel3_IRQHandler(void)
 void USB_LP_CAN1_RX0_IRQHandler(void)
 {
   /* USER CODE BEGIN USB_LP_CAN1_RX0_IRQn 0 */
-
+  idle_isr(IDLE_SRC_USB);
+  memstat_isr(MEMSTAT_LVL_USB);
+  PROF_BEGIN(PROF_ZONE_USB_IRQ);
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 0 */
   HAL_PCD_IRQHandler(&hpcd_USB_FS);
   /* USER CODE BEGIN USB_LP_CAN1_RX0_IRQn 1 */
+  PROF_END(PROF_ZONE_USB_IRQ);
 
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 1 */
 }
 
+/**
+  * @brief This function handles EXTI line[9:5] interrupts.
+  */
+void EXTI9_5_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI9_5_IRQn 0 */
+  idle_isr(IDLE_SRC_INPUT);
+  memstat_isr(MEMSTAT_LVL_INPUT);
+  power_exti_wake();
+  /* USER CODE END EXTI9_5_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(Rot_X_Pin);
+  HAL_GPIO_EXTI_IRQHandler(Rot_Y_Pin);
+  /* USER CODE BEGIN EXTI9_5_IRQn 1 */
+
+  /* USER CODE END EXTI9_5_IRQn 1 */
+}
+
+/**
+  * @brief This function handles EXTI line[15:10] interrupts.
+  */
+void EXTI15_10_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI15_10_IRQn 0 */
+  idle_isr(IDLE_SRC_INPUT);
+  memstat_isr(MEMSTAT_LVL_INPUT);
+  power_exti_wake();
+  /* USER CODE END EXTI15_10_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(Rot_Z_Pin);
+  HAL_GPIO_EXTI_IRQHandler(Rot_F_Pin);
+  /* USER CODE BEGIN EXTI15_10_IRQn 1 */
+
+  /* USER CODE END EXTI15_10_IRQn 1 */
+}
+
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief USB-Wakeup über EXTI18 (weckt aus STOP, siehe power.c)
+  */
+void USBWakeUp_IRQHandler(void)
+{
+  memstat_isr(MEMSTAT_LVL_USB);
+  power_usb_wakeup_irq();
+}
+
 /* USER CODE END 1 */
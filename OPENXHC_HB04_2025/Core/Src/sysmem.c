@@ -29,6 +29,12 @@
  */
 static uint8_t *__sbrk_heap_end = NULL;
 
+/**
+ * Heap statistics for memstat.c: peak size and rejected requests
+ */
+static uint32_t __sbrk_heap_peak = 0;
+static uint32_t __sbrk_fails = 0;
+
 /**
  * @brief _sbrk() allocates memory to the newlib heap and is used by malloc
  *        and others from the C library
@@ -68,12 +74,32 @@ void *_sbrk(ptrdiff_t incr)
   /* Protect heap from growing into the reserved MSP stack */
   if (__sbrk_heap_end + incr > max_heap)
   {
+    __sbrk_fails++;
     errno = ENOMEM;
     return (void *)-1;
   }
 
   prev_heap_end = __sbrk_heap_end;
   __sbrk_heap_end += incr;
+  if ((uint32_t)(__sbrk_heap_end - &_end) > __sbrk_heap_peak)
+  {
+    __sbrk_heap_peak = (uint32_t)(__sbrk_heap_end - &_end);
+  }
 
   return (void *)prev_heap_end;
 }
+
+/**
+ * @brief Heap usage for memstat.c
+ * @param used Current heap size in bytes
+ * @param peak Largest heap size since boot
+ * @param fails Number of _sbrk calls rejected with ENOMEM
+ */
+void sysmem_get_heap(uint32_t *used, uint32_t *peak, uint32_t *fails)
+{
+  extern uint8_t _end; /* Symbol defined in the linker script */
+
+  *used = (NULL == __sbrk_heap_end) ? 0 : (uint32_t)(__sbrk_heap_end - &_end);
+  *peak = __sbrk_heap_peak;
+  *fails = __sbrk_fails;
+}
@@ -0,0 +1,143 @@
+/*
+ * telemetry.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Binärer Telemetrie-Strom über CDC-ACM (nur mit USBD_CDC_TELEMETRY)
+ */
+
+#include "telemetry.h"
+
+#if USBD_CDC_TELEMETRY
+
+#include "diag.h"
+#include "sched.h"
+#include "usbd_customhid.h"
+#include <string.h>
+
+#define TLM_MASK      (TELEMETRY_RING_SIZE - 1u)
+#define TLM_HDR_LEN   10u
+#define TLM_MAX_LEN   (TLM_HDR_LEN + DIAG_MAX_VALUES * 4u + 2u)
+#define TLM_CHUNK     (CDC_TLM_DATA_PACKET_SIZE - 1u)   // immer kurzes Paket: Host liefert sofort aus
+
+#if (TELEMETRY_RING_SIZE & (TELEMETRY_RING_SIZE - 1u)) != 0u
+#error "TELEMETRY_RING_SIZE muss eine Zweierpotenz sein"
+#endif
+
+extern USBD_HandleTypeDef hUsbDeviceFS;
+
+/* SPSC: Producer Telemetrie-Task, Consumer USB-IRQ (telemetry_tx_done) */
+static uint8_t           ring[TELEMETRY_RING_SIZE];
+static volatile uint32_t head = 0, tail = 0;
+static uint32_t          inflight = 0;   // Bytes im laufenden Bulk-IN Transfer
+static uint16_t          seq = 0;
+static uint8_t           next_page = 0;  // hier setzt der nächste Durchlauf fort
+
+static uint16_t crc16(const uint8_t *p, uint32_t len) {
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* Nächstes Paket starten (IRQs gesperrt) */
+static void kick(void) {
+    uint32_t fill = head - tail;
+    if (inflight || !fill) return;
+
+    uint32_t pos = tail & TLM_MASK;
+    uint32_t n = fill;
+    if (n > TELEMETRY_RING_SIZE - pos) n = TELEMETRY_RING_SIZE - pos;
+    if (n > TLM_CHUNK) n = TLM_CHUNK;
+
+    if (USBD_CUSTOM_HID_CdcTransmit(&hUsbDeviceFS, &ring[pos], (uint16_t)n) == USBD_OK) {
+        inflight = n;
+    }
+}
+
+/* Datensatz komplett einreihen oder verwerfen */
+static void push(const uint8_t *rec, uint32_t len) {
+    if (TELEMETRY_RING_SIZE - (head - tail) < len) return;
+
+    uint32_t h = head;
+    for (uint32_t i = 0; i < len; i++) ring[(h + i) & TLM_MASK] = rec[i];
+    __DMB();
+    head = h + len;
+}
+
+/**
+ * @brief Telemetrie-Task (Scheduler, TELEMETRY_PERIOD_MS): Diagnoseseiten
+ *        reihum, so viele wie in den Sendepuffer passen
+ */
+static void telemetry_task(void) {
+    if (!USBD_CUSTOM_HID_CdcIsOpen(&hUsbDeviceFS)) return;
+
+    uint8_t rec[TLM_MAX_LEN];
+    uint32_t tick = HAL_GetTick();
+
+    for (uint8_t i = 0; i < DIAG_PAGE_COUNT; i++) {
+        uint8_t page = next_page;
+        if (page != DIAG_PAGE_PROF_EVENTS) {   // liest den Ring ab, nur auf Anfrage
+            /* Voll: Rest im nächsten Durchlauf statt Datensätze zu verwerfen */
+            if (TELEMETRY_RING_SIZE - (head - tail) < TLM_MAX_LEN) break;
+        }
+        next_page = (uint8_t)((page + 1u) % DIAG_PAGE_COUNT);
+        if (page == DIAG_PAGE_PROF_EVENTS) continue;
+
+        uint8_t n = diag_fill(page, &rec[TLM_HDR_LEN]);
+        uint32_t len = TLM_HDR_LEN + n * 4u;
+
+        rec[0] = 0xA5;
+        rec[1] = 0x5A;
+        rec[2] = page;
+        rec[3] = n;
+        rec[4] = (uint8_t)seq;
+        rec[5] = (uint8_t)(seq >> 8);
+        memcpy(&rec[6], &tick, 4);
+        uint16_t crc = crc16(&rec[2], len - 2u);
+        rec[len] = (uint8_t)crc;
+        rec[len + 1u] = (uint8_t)(crc >> 8);
+        seq++;
+
+        push(rec, len + 2u);
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    kick();
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Meldet den Telemetrie-Task beim Scheduler an
+ */
+void telemetry_init(void) {
+    sched_register(SCHED_TASK_TELEMETRY, telemetry_task, TELEMETRY_PERIOD_MS, 0, 0);
+}
+
+/**
+ * @brief Bulk-IN Paket abgeholt: Platz freigeben, nächstes Paket starten (USB-IRQ)
+ */
+void telemetry_tx_done(void) {
+    tail += inflight;
+    inflight = 0;
+    kick();
+}
+
+/**
+ * @brief Bus-Reset/Neuenumeration (USB-IRQ): der laufende Transfer wird nie
+ *        fertig, also Ring verwerfen und wieder senden lassen
+ *
+ * tail = head landet immer auf einer Datensatzgrenze (push schreibt ganze
+ * Datensätze), der Host sieht danach nur eine Lücke in der Sequenznummer.
+ */
+void telemetry_reset(void) {
+    inflight = 0;
+    tail = head;
+}
+
+#endif /* USBD_CDC_TELEMETRY */
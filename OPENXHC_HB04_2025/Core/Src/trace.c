@@ -0,0 +1,126 @@
+/*
+ * trace.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Thomas Weckmann
+ *      Latenzmessung Eingabe -> USB mit DWT CYCCNT
+ */
+
+#include "trace.h"
+#include "dwt.h"
+#include <string.h>
+
+static trace_hist_t hist[TRACE_STAGE_COUNT];
+static trace_hist_t src_hist[TRACE_SRC_COUNT];   // EDGE_QUEUE je Quelle
+
+#if TRACE_ENABLE
+/* Älteste noch nicht gesendete Flanke und die der gesendeten Reports (FIFO) */
+static uint32_t origin_cycles = 0;
+static uint8_t  origin_valid = 0;
+static uint32_t inflight_cycles[TRACE_INFLIGHT];
+static uint8_t  inflight_valid[TRACE_INFLIGHT];
+static uint32_t inflight_head = 0, inflight_tail = 0;
+
+static inline void add_to(trace_hist_t *h, uint32_t cycles) {
+    uint32_t us = dwt_to_us(cycles);
+    uint32_t b = us ? (31U - (uint32_t)__builtin_clz(us)) : 0;
+    if (b >= TRACE_BUCKETS) b = TRACE_BUCKETS - 1;
+    h->bucket[b]++;
+}
+
+static inline void add(trace_stage_t stage, uint32_t cycles) {
+    add_to(&hist[stage], cycles);
+}
+
+/**
+ * @brief Eingabeänderung wird gemeldet (edge_cycles = erste Beobachtung der Flanke)
+ */
+void trace_input(trace_src_t src, uint32_t edge_cycles) {
+    uint32_t now = dwt_cycles();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    add(TRACE_EDGE_QUEUE, now - edge_cycles);
+    if (src < TRACE_SRC_COUNT) add_to(&src_hist[src], now - edge_cycles);
+    if (!origin_valid) {
+        origin_cycles = edge_cycles;
+        origin_valid = 1;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Report wurde an den Klassentreiber übergeben (USB-IRQ)
+ * @param pending Report enthält eine Änderung (sonst Keepalive/Übertrag ohne Flanke)
+ */
+void trace_send(uint32_t queued_cycles, uint32_t tx_cycles, uint8_t pending) {
+    if (pending) add(TRACE_QUEUE_SEND, tx_cycles - queued_cycles);
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (inflight_head - inflight_tail < TRACE_INFLIGHT) {
+        uint32_t i = inflight_head++ % TRACE_INFLIGHT;
+        inflight_cycles[i] = origin_cycles;
+        inflight_valid[i] = origin_valid;
+        origin_valid = 0;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief DataIn-Completion des ältesten Reports (USB-IRQ)
+ */
+void trace_done(uint32_t tx_cycles, uint32_t done_cycles) {
+    add(TRACE_SEND_DONE, done_cycles - tx_cycles);
+    if (inflight_head == inflight_tail) return;
+
+    uint32_t i = inflight_tail++ % TRACE_INFLIGHT;
+    if (inflight_valid[i]) add(TRACE_EDGE_DONE, done_cycles - inflight_cycles[i]);
+}
+
+/**
+ * @brief Verwirft die gesendeten Reports (USB-Reset, nicht konfiguriert)
+ */
+void trace_flush(void) {
+    inflight_tail = inflight_head;
+}
+#endif
+
+/**
+ * @brief Liefert das Histogramm einer Stufe (Kopie)
+ */
+void trace_get_hist(trace_stage_t stage, trace_hist_t *out) {
+    if (stage >= TRACE_STAGE_COUNT) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = hist[stage];
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Liefert das Histogramm Flanke -> Report anstehend einer Quelle (Kopie)
+ */
+void trace_get_src_hist(trace_src_t src, trace_hist_t *out) {
+    if (src >= TRACE_SRC_COUNT) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = src_hist[src];
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Löscht alle Histogramme
+ */
+void trace_reset(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memset(hist, 0, sizeof(hist));
+    memset(src_hist, 0, sizeof(src_hist));
+    __set_PRIMASK(primask);
+}
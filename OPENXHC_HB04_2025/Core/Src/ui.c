@@ -34,6 +34,9 @@ static void Print(int x, int y, const char *s, FontDef f, uint16_t col){
     ST7735_WriteString(x, y, s, f, col, UI_BG);
 }
 
+// Aktive Achse des Wahlschalters (0..2), -1 = keine
+static int8_t activeAxis = -1;
+
 // Koordinaten der Zahlenblöcke
 static const int VAL_X = 60;             // Start X der Werte (rechts neben "X:")
 static const int LABEL_X = UI_MARGIN_L;  // "WC", "MC", "X:", "Y:", "Z:"
@@ -138,9 +141,14 @@ static char lastY[20] = "";
 static char lastZ[20] = "";
 
 void UI_UpdateWC(float x, float y, float z) {
-    DrawValue(UI_TOP_H1_Y, x, lastX);
-    DrawValue(UI_TOP_H1_Y+14, y, lastY);
-    DrawValue(UI_TOP_H1_Y+28, z, lastZ);
+    const float v[3] = {x, y, z};
+    char *last[3] = {lastX, lastY, lastZ};
+
+    // aktive Achse zuerst, sie ändert sich beim Drehen des Handrads
+    if (activeAxis >= 0) DrawValue(UI_TOP_H1_Y + 14*activeAxis, v[activeAxis], last[activeAxis]);
+    for (int i = 0; i < 3; i++) {
+        if (i != activeAxis) DrawValue(UI_TOP_H1_Y + 14*i, v[i], last[i]);
+    }
 }
 
 
@@ -149,6 +157,20 @@ void UI_UpdateMC(float x, float y, float z) {
     DrawValue(UI_TOP_H2_Y+14,  y, lastMC_Y);
     DrawValue(UI_TOP_H2_Y+28,  z, lastMC_Z);
 }
+void UI_SetActiveAxis(int8_t axis){
+    static const char *labels[3] = {"X:", "Y:", "Z:"};
+    if (axis > 2) axis = -1;
+    if (axis == activeAxis) return;
+
+    // alte Markierung zurücksetzen, neue invertiert zeichnen (WC-Block)
+    if (activeAxis >= 0)
+        ST7735_WriteString(40, UI_TOP_H1_Y + 14*activeAxis, labels[activeAxis], FONT_M, UI_FG, UI_BG);
+    if (axis >= 0)
+        ST7735_WriteString(40, UI_TOP_H1_Y + 14*axis, labels[axis], FONT_M, UI_BG, UI_BLUE);
+
+    activeAxis = axis;
+}
+
 void UI_UpdatePosText(const char *text){
     // überschreibe „POS: <...>“ rechts vom Label
     ST7735_FillRectangleFast(4+40, UI_BAR_Y+3, 60, FONT_S.height, UI_BLUE);
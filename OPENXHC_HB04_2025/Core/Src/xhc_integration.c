@@ -9,7 +9,16 @@
 
 #include "xhc_integration.h"
 #include "ui.h"
+#include "st7735.h"
 #include "usbd_customhid.h"
+#include "usbd_custom_hid_if.h"
+#include "dwt.h"
+#include "defer.h"
+#include "trace.h"
+#include "sched.h"
+#include "settings.h"
+#include "ramfunc.h"
+#include "prof.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -21,17 +30,124 @@ struct whb04_out_data xhc_output_report = {0};
 struct whb0x_in_data xhc_input_report = {.id = 0x04};
 uint8_t xhc_day = 0;
 
+#define XHC_DISPLAY_BUDGET_US  20000   // Anzeige-Task, darüber zählt ein Überlauf
+
+static void xhc_stats_task(void);
+static void xhc_display_boot(void);
+
+_Static_assert(XHC_IN_QUEUE_MAX >= 1 && XHC_IN_QUEUE_MAX <= USBD_CUSTOMHID_IN_FIFO_DEPTH + 1,
+               "XHC_IN_QUEUE_MAX passt nicht zur Report-FIFO");
+_Static_assert(XHC_IN_QUEUE_MAX <= TRACE_INFLIGHT, "TRACE_INFLIGHT zu klein");
+_Static_assert(sizeof(struct whb0x_in_data) <= USBD_CUSTOMHID_IN_REPORT_MAX, "Input-Report passt nicht in die FIFO");
+
 /* USB Reception State Machine */
 #define TMP_BUFF_SIZE 42
 #define CHUNK_SIZE    7
 static uint8_t tmp_buff[TMP_BUFF_SIZE];
 static int offset = 0;
 static uint8_t magic_found = 0;
+static struct whb04_out_data rx_frame = {0};  // letztes komplettes Paket (schreibt nur PendSV)
+static volatile uint8_t frame_ready = 0;      // rx_frame neu, Anzeige ausstehend
+static uint8_t orphan_run = 0;    // seit dem letzten Frame Chunks ohne Magic verworfen
+
+/* Protokollstatistik: Zähler schreibt PendSV (xhc_rx_work), frames_per_sec
+ * die Hauptschleife; Kopie nur unter PRIMASK (xhc_get_rx_stats) */
+static xhc_rx_stats_t rx_stats = {0};
+static uint32_t       rx_frames_last_sec = 0;
+static uint32_t       last_frame_cycles = 0;
+static volatile uint32_t last_rx_tick = 0;    // HAL-Tick des letzten Chunks vom Host
 
 
 /* Timing and State Tracking */
 static uint32_t last_display_update = 0;
 static uint32_t last_usb_send = 0;
+
+/* Aktueller Eingangszustand (wird von den Input-Scannern gepflegt) */
+static volatile struct {
+    uint8_t btn_1;
+    uint8_t btn_2;
+    uint8_t wheel_mode;
+    int32_t wheel;       // aufgelaufene Encoder-Schritte, noch nicht gesendet
+} input_state = { .wheel_mode = ROTARY_X };
+
+static volatile uint8_t  report_pending = 0;  // Zustand geändert -> Report beim nächsten SOF
+static volatile uint8_t  wheel_mode_changed = 1;  // Anzeige der Schalterstellung ausstehend
+static uint8_t           wheel_carry = 0;         // Handrad-Rest offen -> ohne Mindestabstand senden
+
+/* Schalterwechsel mit offenem Handrad-Rest: der Rest geht noch unter der
+ * alten Stellung hinaus, jede weitere Stellung sammelt ihre Schritte in
+ * einem eigenen Eintrag. xhc_usb_sof arbeitet die Einträge der Reihe nach
+ * ab. Zugriff nur mit gesperrten IRQs oder im USB-IRQ. */
+static struct {
+    uint8_t wheel_mode;
+    int32_t steps;
+} wheel_queue[XHC_WHEEL_QUEUE];
+static uint32_t          wq_head = 0, wq_tail = 0;
+static volatile uint8_t  mode_want = ROTARY_X;   // letzte gemeldete Schalterstellung
+static xhc_wheel_stats_t wheel_stats = {0};
+static volatile uint32_t last_report_tick = (uint32_t)-XHC_KEEPALIVE_MS;   // erster Report gleich nach Enumeration
+
+/* IN-Endpoint: Reports von SendReport bis zur DataIn-Completion (FIFO-Reihenfolge) */
+static volatile uint32_t in_head = 0, in_tail = 0;
+static uint32_t          tx_ring[XHC_IN_QUEUE_MAX];   // DWT: Übergabe an den Klassentreiber
+static uint32_t          done_cycles = 0;             // DWT: letzte Completion
+static volatile uint32_t pending_since = 0;   // DWT: erste Änderung seit letztem Report
+static uint32_t          tx_cycles = 0;       // DWT: letzter Transmit
+static uint32_t          in_completed_last_sec = 0;
+static uint32_t          in_stats_tick = 0;
+static xhc_in_stats_t    in_stats = {0};
+
+/* Markiert den Zustand als geändert (nur mit gesperrten IRQs aufrufen) */
+static inline void mark_pending(void) {
+    if (!report_pending) {
+        pending_since = dwt_cycles();
+        report_pending = 1;
+    }
+}
+
+/* Übernimmt die Schalterstellung für die folgenden Reports (IRQs gesperrt) */
+static void apply_wheel_mode(uint8_t wheel_mode) {
+    input_state.wheel_mode = wheel_mode;
+    wheel_mode_changed = 1;
+    mark_pending();
+    sched_signal(SCHED_EV_DISPLAY);
+}
+
+/* Letzter Eintrag der Warteschlange, NULL wenn leer */
+static inline int32_t *wheel_tail_steps(uint8_t *wheel_mode) {
+    if (wq_head == wq_tail) {
+        *wheel_mode = input_state.wheel_mode;
+        return NULL;
+    }
+    uint32_t i = (wq_head - 1u) % XHC_WHEEL_QUEUE;
+    *wheel_mode = wheel_queue[i].wheel_mode;
+    return &wheel_queue[i].steps;
+}
+
+/* Stellt mode_want hinter die offenen Reste (IRQs gesperrt) */
+static void wheel_queue_sync(void) {
+    uint8_t tail_mode;
+    int32_t *tail = wheel_tail_steps(&tail_mode);
+
+    /* Zwischenstellung ohne Schritte: entfällt */
+    while (tail && *tail == 0 && tail_mode != mode_want) {
+        wq_head--;
+        tail = wheel_tail_steps(&tail_mode);
+    }
+    if (tail_mode == mode_want) return;
+
+    if (!tail && input_state.wheel == 0) {
+        apply_wheel_mode(mode_want);
+    } else if (wq_head - wq_tail < XHC_WHEEL_QUEUE) {
+        uint32_t i = wq_head % XHC_WHEEL_QUEUE;
+        wheel_queue[i].wheel_mode = mode_want;
+        wheel_queue[i].steps = 0;
+        wq_head++;
+        wheel_stats.mode_holds++;
+    }
+    /* sonst voll: Eintrag folgt, sobald xhc_usb_sof einen abgearbeitet hat */
+}
+
 static struct {
     uint32_t wc_pos_cache[3];    // Cache für WC X,Y,Z
     uint32_t mc_pos_cache[3];    // Cache für MC X,Y,Z
@@ -43,10 +159,19 @@ static struct {
  */
 void xhc_init(void) {
     memset(&xhc_output_report, 0, sizeof(xhc_output_report));
+    memset(&rx_frame, 0, sizeof(rx_frame));
     memset(&xhc_input_report, 0, sizeof(xhc_input_report));
     xhc_input_report.id = 0x04;
     position_cache.first_update = 1;
 
+    defer_register(DEFER_RX, xhc_rx_work);
+    /* Display-Init läuft als Schrittkette im Anzeige-Slot, USB und Eingaben
+       arbeiten währenddessen schon; danach übernimmt xhc_main_loop */
+    ST7735_InitStart();
+    sched_register(SCHED_TASK_DISPLAY, xhc_display_boot, 1, 0, XHC_DISPLAY_BUDGET_US);
+    sched_register(SCHED_TASK_STATS, xhc_stats_task, 1000, 0, 0);
+    sched_signal(SCHED_EV_DISPLAY);   // Schalterstellung erstmals anzeigen (nach dem Init)
+
     // UI bereits initialisiert - nur Reset der Position-Caches
     for (int i = 0; i < 3; i++) {
         position_cache.wc_pos_cache[i] = 0xFFFFFFFF;
@@ -55,17 +180,30 @@ void xhc_init(void) {
 }
 
 /**
- * @brief USB-Datenempfang (wird von USB-Stack aufgerufen)
+ * @brief USB-Datenempfang (aus xhc_rx_work, PendSV-Kontext)
  * @param data 7-Byte Chunks vom Host
  */
-void xhc_receive_data(uint8_t *data) {
+RAMFUNC void xhc_receive_data(const uint8_t *data) {
     /* Prüfe auf Magic-Wert am Anfang */
-    if (*(uint16_t*)data == WHBxx_MAGIC) {
+    if (*(const uint16_t*)data == WHBxx_MAGIC) {
+        if (magic_found) {
+            rx_stats.incomplete++;      // vorheriges Paket nicht vollständig
+        } else if (orphan_run) {
+            rx_stats.resyncs++;
+        }
+        orphan_run = 0;
         offset = 0;
         magic_found = 1;
     }
 
-    if (!magic_found || (offset + CHUNK_SIZE) > TMP_BUFF_SIZE) {
+    if (!magic_found) {
+        rx_stats.orphan_chunks++;
+        orphan_run = 1;
+        return;
+    }
+
+    if ((offset + CHUNK_SIZE) > TMP_BUFF_SIZE) {
+        rx_stats.overflow++;
         return;
     }
 
@@ -77,12 +215,26 @@ void xhc_receive_data(uint8_t *data) {
     if (offset >= DEV_WHB04) {
         magic_found = 0;
 
-        /* Kopiere empfangene Daten */
-        xhc_output_report = *((struct whb04_out_data*)tmp_buff);
-        xhc_day = xhc_output_report.day;
+        uint32_t now = dwt_cycles();
+        if (rx_stats.frames) {
+            uint32_t gap_us = dwt_to_us(now - last_frame_cycles);
+            rx_stats.gap_last_us = gap_us;
+            if (gap_us > rx_stats.gap_max_us) rx_stats.gap_max_us = gap_us;
+        }
+        last_frame_cycles = now;
+        rx_stats.frames++;
+
+        if (memcmp(tmp_buff, &rx_frame, DEV_WHB04) == 0) {
+            rx_stats.duplicates++;
+        }
+
+        /* Kopiere empfangene Daten; die Anzeige übernimmt sie in xhc_main_loop */
+        rx_frame = *((struct whb04_out_data*)tmp_buff);
+        xhc_day = rx_frame.day;
 
-        /* Verarbeite die Daten */
-        xhc_process_received_data();
+        /* Anzeige erst nach dem Leeren des Empfangspuffers (nur letztes Paket zählt) */
+        frame_ready = 1;
+        sched_signal(SCHED_EV_DISPLAY);
     }
 }
 
@@ -125,10 +277,6 @@ void xhc_process_received_data(void) {
         UI_UpdateWC(wc_x, wc_y, wc_z);
 
         // Update weitere UI-Elemente
-        char pos_text[10];
-        snprintf(pos_text, sizeof(pos_text), "ON");
-        UI_UpdatePosText(pos_text);
-
         char step_text[10];
         snprintf(step_text, sizeof(step_text), "%d.%03d",
                  xhc_output_report.step_mul / 1000,
@@ -155,10 +303,18 @@ void xhc_process_received_data(void) {
 uint8_t xhc_send_input_report(uint8_t btn1, uint8_t btn2, uint8_t wheel_mode, int8_t wheel_value) {
     uint32_t current_time = HAL_GetTick();
 
-    /* Rate Limiting: mindestens 10ms zwischen Sends */
-    if (current_time - last_usb_send < 10) {
+    /* Warteschlange voll: Reports noch nicht vom Host abgeholt */
+    if (in_head - in_tail >= XHC_IN_QUEUE_MAX) {
+        return USBD_BUSY;
+    }
+
+#if !XHC_LOW_LATENCY
+    /* Rate Limiting: mindestens XHC_IN_MIN_INTERVAL_MS zwischen Sends,
+       außer ein Handrad-Übertrag wird nachgeliefert */
+    if (!wheel_carry && current_time - last_usb_send < XHC_IN_MIN_INTERVAL_MS) {
         return USBD_BUSY;
     }
+#endif
 
     /* Fülle Input Report */
     xhc_input_report.btn_1 = btn1;
@@ -174,32 +330,339 @@ uint8_t xhc_send_input_report(uint8_t btn1, uint8_t btn2, uint8_t wheel_mode, in
 
     if (result == USBD_OK) {
         last_usb_send = current_time;
+        if (hUsbDeviceFS.dev_state == USBD_STATE_CONFIGURED) {
+            tx_cycles = dwt_cycles();
+            if (in_head != in_tail) in_stats.prearmed++;
+            tx_ring[in_head % XHC_IN_QUEUE_MAX] = tx_cycles;
+            in_head++;
+            in_stats.in_sent++;
+        }
     }
 
     return result;
 }
 
+/**
+ * @brief DataIn-Completion des IN-Endpoints (USB-IRQ)
+ */
+void xhc_in_complete(void) {
+    if (in_head == in_tail) return;
+
+    uint32_t now = dwt_cycles();
+    uint32_t queued = tx_ring[in_tail % XHC_IN_QUEUE_MAX];
+    in_tail++;
+
+    /* Eingereihte Reports liegen erst ab der vorigen Completion am Endpoint */
+    uint32_t armed = ((int32_t)(done_cycles - queued) > 0) ? done_cycles : queued;
+    uint32_t poll_us = dwt_to_us(now - armed);
+    done_cycles = now;
+
+    trace_done(armed, now);
+
+    if (!in_stats.boot_report_ms) in_stats.boot_report_ms = HAL_GetTick();
+    in_stats.in_completed++;
+    in_stats.poll_last_us = poll_us;
+    if (poll_us > in_stats.poll_max_us) in_stats.poll_max_us = poll_us;
+}
+
+/**
+ * @brief Aktueller Eingabezustand als Input-Report 0x04 (GET_REPORT, USB-IRQ)
+ *
+ * Tasten und Schalterstellung wie im nächsten IN-Report. Das Handrad ist
+ * relativ: Schritte gehen nur über den Interrupt-Endpoint raus, hier 0.
+ * @param len Länge des Reports
+ * @return Zeiger auf den statischen Report-Puffer
+ */
+uint8_t *xhc_get_input_report(uint16_t *len) {
+    static struct whb0x_in_data snapshot;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    snapshot.id = 0x04;
+    snapshot.btn_1 = input_state.btn_1;
+    snapshot.btn_2 = input_state.btn_2;
+    snapshot.wheel_mode = input_state.wheel_mode;
+    snapshot.wheel = 0;
+    snapshot.xor_day = xhc_day ^ input_state.btn_1;
+    in_stats.get_reports++;
+    __set_PRIMASK(primask);
+
+    *len = sizeof(snapshot);
+    return (uint8_t*)&snapshot;
+}
 
 /**
- * @brief Hauptschleife für XHC-Integration
+ * @brief Liefert die IN-Statistik (Kopie)
  */
-void xhc_main_loop(void) {
-    static uint32_t last_keepalive = 0;
-    uint32_t current_time = HAL_GetTick();
+void xhc_get_in_stats(xhc_in_stats_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = in_stats;
+    __set_PRIMASK(primask);
+}
 
-    /* Hier würden normalerweise Inputs gelesen werden:
-     * - Button Matrix
-     * - Encoder
-     * - Rotary Switch
-     *
-     * Für jetzt: Keepalive alle 100ms
+
+/**
+ * @brief Setzt die aktuell gedrückten Tasten (Tastencodes, 0 = keine)
+ */
+void xhc_set_buttons(uint8_t btn1, uint8_t btn2) {
+    if (input_state.btn_1 == btn1 && input_state.btn_2 == btn2) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    input_state.btn_1 = btn1;
+    input_state.btn_2 = btn2;
+    mark_pending();
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Setzt die Position des Achs-/Funktionswahlschalters (ROTARY_*)
+ *
+ * Ist vom Handrad noch ein Rest offen, wird die neue Stellung mit ihren
+ * eigenen Schritten dahinter eingereiht und gilt erst, wenn alle Reste
+ * davor gesendet sind (xhc_usb_sof).
+ */
+void xhc_set_wheel_mode(uint8_t wheel_mode) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    mode_want = wheel_mode;
+    wheel_queue_sync();
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Addiert Encoder-Schritte; was nicht in einen Report (int8) passt,
+ *        wird in den folgenden Reports nachgeliefert
+ */
+void xhc_add_wheel(int32_t delta) {
+    if (delta == 0) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint8_t tail_mode;
+    int32_t *tail = wheel_tail_steps(&tail_mode);
+    if (tail_mode != mode_want) {
+        /* Warteschlange voll: die Stellung hat keinen Eintrag */
+        wheel_stats.steps_dropped += (uint32_t)(delta < 0 ? -delta : delta);
+    } else if (tail) {
+        *tail += delta;
+    } else {
+        input_state.wheel += delta;
+        mark_pending();
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Liefert die Statistik zu Schalterwechseln mit Handrad-Rest (Kopie)
+ */
+void xhc_get_wheel_stats(xhc_wheel_stats_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = wheel_stats;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Resume nach USB-Suspend (USB-IRQ): der Host kennt den Zustand von
+ *        vor dem Suspend, also im ersten SOF einen aktuellen Report senden
+ * @param keep_wheel 1 = Remote Wakeup durch das Pendant: gedrehte Schritte
+ *        senden; sonst verwerfen (der Host hat geschlafen, kein Jog danach)
+ */
+void xhc_usb_resume(uint8_t keep_wheel) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!keep_wheel) {
+        int32_t w = input_state.wheel;
+        uint32_t dropped = (uint32_t)(w < 0 ? -w : w);
+        for (; wq_tail != wq_head; wq_tail++) {
+            int32_t n = wheel_queue[wq_tail % XHC_WHEEL_QUEUE].steps;
+            dropped += (uint32_t)(n < 0 ? -n : n);
+        }
+        wheel_stats.steps_dropped += dropped;
+        input_state.wheel = 0;
+        if (input_state.wheel_mode != mode_want) apply_wheel_mode(mode_want);
+    }
+    mark_pending();
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief SOF-Hook (1 ms, USB-IRQ): sendet bei Zustandsänderung sofort,
+ *        sonst nur alle XHC_KEEPALIVE_MS einen Keepalive-Report.
+ */
+void xhc_usb_sof(void) {
+    if (hUsbDeviceFS.dev_state != USBD_STATE_CONFIGURED) {
+        in_tail = in_head;
+        trace_flush();
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+
+    /* Completions pro Sekunde */
+    if (now - in_stats_tick >= 1000) {
+        in_stats.in_per_sec = in_stats.in_completed - in_completed_last_sec;
+        in_completed_last_sec = in_stats.in_completed;
+        in_stats_tick = now;
+    }
+
+    if (!report_pending && (now - last_report_tick) < XHC_KEEPALIVE_MS) return;
+
+    /* Änderungen dürfen hinter den laufenden Transfer, Keepalives nicht */
+    uint32_t queued = in_head - in_tail;
+    if (queued >= XHC_IN_QUEUE_MAX || (queued && !report_pending)) {
+        if (report_pending) in_stats.busy_frames++;
+        return;
+    }
+
+    /* Läuft im USB-IRQ: die Setter sperren IRQs, der Zustand ist hier konsistent.
+     * Pro Report höchstens int8, der Rest bleibt für die nächsten Frames stehen. */
+    uint8_t was_pending = report_pending;
+    int32_t wheel = input_state.wheel;
+    if (wheel > 127)  wheel = 127;
+    if (wheel < -128) wheel = -128;
+
+    if (xhc_send_input_report(input_state.btn_1, input_state.btn_2,
+                              input_state.wheel_mode, (int8_t)wheel) == USBD_OK) {
+        if (was_pending) {
+            uint32_t wait_us = dwt_to_us(tx_cycles - pending_since);
+            in_stats.wait_last_us = wait_us;
+            if (wait_us > in_stats.wait_max_us) in_stats.wait_max_us = wait_us;
+            /* gleitender Mittelwert, Gewicht 1/8 */
+            in_stats.wait_avg_us = in_stats.wait_avg_us - (in_stats.wait_avg_us >> 3) + (wait_us >> 3);
+        }
+        trace_send(pending_since, tx_cycles, was_pending);
+        input_state.wheel -= wheel;
+        last_report_tick = now;
+
+        if (input_state.wheel != 0) {
+            /* Übertrag: sofort wieder anstehend, der nächste Report wird hinter diesen eingereiht */
+            uint32_t carry = (uint32_t)(input_state.wheel < 0 ? -input_state.wheel : input_state.wheel);
+            in_stats.carry_reports++;
+            in_stats.carry_last = carry;
+            if (carry > in_stats.carry_max) in_stats.carry_max = carry;
+            pending_since = tx_cycles;
+            wheel_carry = 1;
+        } else {
+            in_stats.carry_last = 0;
+            wheel_carry = 0;
+            report_pending = 0;
+
+            if (wq_head != wq_tail) {
+                /* Rest der alten Stellung ist gesendet: nächste Stellung mit ihren Schritten */
+                uint32_t i = wq_tail % XHC_WHEEL_QUEUE;
+                wq_tail++;
+                input_state.wheel = wheel_queue[i].steps;
+                apply_wheel_mode(wheel_queue[i].wheel_mode);
+                wheel_queue_sync();   // war die Warteschlange voll
+            }
+        }
+    }
+}
+
+/**
+ * @brief Deferred Work (PendSV): empfangene Feature-Reports (ID 0x06)
+ *        ohne Kopie aus dem Ring dekodieren
+ */
+void xhc_rx_work(void) {
+    const xhc_rx_item_t *item;
+    while ((item = XHC_RX_Peek()) != NULL) {
+        last_rx_tick = HAL_GetTick();
+        if (item->len >= 8 && item->data[0] == 0x06) {
+            xhc_receive_data(&item->data[1]);  // Überspringe Report ID
+        }
+        XHC_RX_Commit();
+    }
+}
+
+/**
+ * @brief Zeit seit dem letzten Chunk vom Host (ms); ab Boot gezählt, wenn noch keiner kam
+ */
+uint32_t xhc_rx_idle_ms(void) {
+    return HAL_GetTick() - last_rx_tick;
+}
+
+/**
+ * @brief Zeigt die Schalterstellung an (POS-Text, aktive Achse)
+ */
+static void xhc_show_wheel_mode(uint8_t wheel_mode) {
+    static const char *names[] = {"X", "Y", "Z", "A", "SPDL", "FEED"};
+
+    if (wheel_mode >= ROTARY_X && wheel_mode <= ROTARY_FEED) {
+        UI_UpdatePosText(names[wheel_mode - ROTARY_X]);
+    } else {
+        UI_UpdatePosText("OFF");
+    }
+    UI_SetActiveAxis((wheel_mode >= ROTARY_X && wheel_mode <= ROTARY_Z) ? (int8_t)(wheel_mode - ROTARY_X) : -1);
+}
+
+/**
+ * @brief Display-Init (Scheduler, Periode = Wartezeit des nächsten Schritts);
+ *        zum Schluss statisches Layout zeichnen und Slot an xhc_main_loop übergeben
+ */
+static void xhc_display_boot(void) {
+    uint16_t ms = ST7735_InitStep();
+    if (ms) {
+        sched_register(SCHED_TASK_DISPLAY, xhc_display_boot, ms, 0, XHC_DISPLAY_BUDGET_US);
+        return;
+    }
+
+    if (settings_get(SETTINGS_KEY_DISPLAY_FLIP)) ST7735_SetFlip(true);
+    UI_DrawStatic();
+    sched_register(SCHED_TASK_DISPLAY, xhc_main_loop, 0, SCHED_EV_DISPLAY, XHC_DISPLAY_BUDGET_US);
+    sched_signal(SCHED_EV_DISPLAY);
+}
+
+/**
+ * @brief Anzeige-Task (Scheduler, SCHED_EV_DISPLAY)
+ */
+void xhc_main_loop(void) {
+    /* Inputs (Button Matrix, Encoder, Wahlschalter) melden Änderungen über
+     * xhc_set_buttons() / xhc_set_wheel_mode() / xhc_add_wheel().
+     * Gesendet wird framesynchron im SOF-Callback (xhc_usb_sof).
      */
-    if (current_time - last_keepalive >= 100) {
-        xhc_send_input_report(0, 0, ROTARY_X, 0);
-        last_keepalive = current_time;
+
+    /* Schalterstellung vor allem anderen anzeigen */
+    if (wheel_mode_changed) {
+        wheel_mode_changed = 0;
+        xhc_show_wheel_mode(input_state.wheel_mode);
+    }
+
+    /* Dekodiert wird im PendSV (xhc_rx_work), hier nur das letzte Paket anzeigen */
+    if (frame_ready) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        xhc_output_report = rx_frame;
+        frame_ready = 0;
+        __set_PRIMASK(primask);
+        PROF_BEGIN(PROF_ZONE_PROCESS_RX);
+        xhc_process_received_data();
+        PROF_END(PROF_ZONE_PROCESS_RX);
     }
 }
 
+/**
+ * @brief Raten je Sekunde (Scheduler, periodisch 1 s)
+ */
+static void xhc_stats_task(void) {
+    rx_stats.frames_per_sec = rx_stats.frames - rx_frames_last_sec;
+    rx_frames_last_sec = rx_stats.frames;
+}
+
+/**
+ * @brief Liefert die Protokollstatistik inkl. Ringpuffer-Zähler (Kopie)
+ */
+void xhc_get_rx_stats(xhc_rx_stats_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = rx_stats;
+    __set_PRIMASK(primask);
+    out->ring_dropped = XHC_RX_Dropped();
+    out->ring_highwater = XHC_RX_HighWater();
+}
+
 /**
  * @brief Extrahiert WC-Position für gegebene Achse
  */
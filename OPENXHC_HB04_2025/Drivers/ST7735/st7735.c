@@ -1,6 +1,9 @@
 /* vim: set ai et ts=4 sw=4: */
 #include "stm32f1xx_hal.h"
 #include "st7735.h"
+#include "ramfunc.h"
+#include "prof.h"
+#include "idle.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -41,7 +44,16 @@ void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
     }
 }
 
-static inline void ST_WaitDMA(void)     { while (st_dma_busy) { __NOP(); } }
+/* Schläft bis zum DMA-IRQ statt zu pollen (Prüfen und WFI mit gesperrten IRQs) */
+static inline void ST_WaitDMA(void)
+{
+    if (!st_dma_busy) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    while (st_dma_busy) { idle_sleep(IDLE_SITE_DMA); }
+    __set_PRIMASK(primask);
+}
 static inline void ST_StartDMA(uint8_t *buf, uint16_t len)
 {
     st_dma_busy = 1;
@@ -127,27 +139,47 @@ static const uint8_t init_cmds3[] = {
     ST7735_DISPON , DELAY, 100
 };
 
-static void ST_ExecCmdList(const uint8_t *p)
+static const uint8_t *const init_lists[] = { init_cmds1, init_cmds2, init_cmds3 };
+
+/* Fortschritt der nicht blockierenden Initialisierung */
+static struct {
+    uint8_t        phase;     // 0..2 Reset, 3 Kommandolisten, 4 fertig
+    uint8_t        list;      // Index in init_lists
+    uint8_t        left;      // verbleibende Kommandos der Liste
+    const uint8_t *p;
+} init_st = { .phase = 0 };
+
+/* Führt Kommandos aus, bis eines eine Wartezeit verlangt; 0 = Listen fertig */
+static uint16_t ST_ExecCmdStep(void)
 {
-    uint8_t n = *p++;
-    while (n--) {
-        uint8_t cmd = *p++;
-        ST_WriteCommand(cmd);
-
-        uint8_t numArgs = *p++;
-        uint16_t ms = numArgs & DELAY;
-        numArgs &= ~DELAY;
-
-        if (numArgs) {
-            ST_WriteData(p, numArgs);
-            p += numArgs;
+    while (init_st.list < sizeof(init_lists) / sizeof(init_lists[0])) {
+        if (!init_st.p) {
+            init_st.p = init_lists[init_st.list];
+            init_st.left = *init_st.p++;
         }
-        if (ms) {
-            ms = *p++;
-            if (ms == 255) ms = 500;
-            HAL_Delay(ms);
+        while (init_st.left) {
+            init_st.left--;
+            uint8_t cmd = *init_st.p++;
+            ST_WriteCommand(cmd);
+
+            uint8_t numArgs = *init_st.p++;
+            uint16_t ms = numArgs & DELAY;
+            numArgs &= ~DELAY;
+
+            if (numArgs) {
+                ST_WriteData(init_st.p, numArgs);
+                init_st.p += numArgs;
+            }
+            if (ms) {
+                ms = *init_st.p++;
+                if (ms == 255) ms = 500;
+                return ms;
+            }
         }
+        init_st.list++;
+        init_st.p = NULL;
     }
+    return 0;
 }
 
 /* ------------------------------ Address Window ---------------------------- */
@@ -179,20 +211,56 @@ void ST7735_Select(void) {
 
 void ST7735_Unselect(void) { CS_HIGH(); }
 
-static void ST_Reset(void)
+/* Nicht blockierende Initialisierung (Reset + Kommandolisten, ~900 ms Wartezeit):
+   ST7735_InitStart(), dann ST7735_InitStep() jeweils nach der gelieferten
+   Wartezeit erneut aufrufen, bis es 0 liefert. */
+void ST7735_InitStart(void)
+{
+    init_st.phase = 0;
+    init_st.list = 0;
+    init_st.p = NULL;
+}
+
+uint16_t ST7735_InitStep(void)
+{
+    uint16_t ms;
+
+    switch (init_st.phase) {
+    case 0:
+        CS_HIGH(); RST_HIGH();
+        init_st.phase = 1;
+        return 5;
+    case 1:
+        RST_LOW();
+        init_st.phase = 2;
+        return 5;
+    case 2:
+        RST_HIGH();
+        init_st.phase = 3;
+        return 120;
+    case 3:
+        ms = ST_ExecCmdStep();
+        if (ms) return ms;
+        init_st.phase = 4;
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+bool ST7735_IsReady(void)
 {
-    RST_LOW();  HAL_Delay(5);
-    RST_HIGH(); HAL_Delay(120);
+    return init_st.phase == 4;
 }
 
 void ST7735_Init(void)
 {
-    CS_HIGH(); RST_HIGH(); HAL_Delay(5);
+    uint16_t ms;
 
-    ST_Reset();
-    ST_ExecCmdList(init_cmds1);
-    ST_ExecCmdList(init_cmds2);
-    ST_ExecCmdList(init_cmds3);
+    ST7735_InitStart();
+    while ((ms = ST7735_InitStep()) != 0) {
+        HAL_Delay(ms);
+    }
 
     /* optional clear */
     uint16_t bg = ST7735_BLACK;
@@ -207,8 +275,8 @@ void ST7735_DrawPixel(uint16_t x, uint16_t y, uint16_t color)
     ST_WriteData(d, 2);
 }
 
-static void ST_WriteChar(uint16_t x, uint16_t y, char ch,
-                         FontDef font, uint16_t color, uint16_t bgcolor)
+static RAMFUNC void ST_WriteChar(uint16_t x, uint16_t y, char ch,
+                                 FontDef font, uint16_t color, uint16_t bgcolor)
 {
     uint32_t i, b, j;
 
@@ -229,6 +297,7 @@ static void ST_WriteChar(uint16_t x, uint16_t y, char ch,
 void ST7735_WriteString(uint16_t x, uint16_t y, const char* s,
                         FontDef font, uint16_t color, uint16_t bgcolor)
 {
+    PROF_BEGIN(PROF_ZONE_WRITE_STRING);
     while (*s) {
         if (x + font.width >= ST7735_WIDTH) {
             x = 0;
@@ -240,10 +309,30 @@ void ST7735_WriteString(uint16_t x, uint16_t y, const char* s,
         x += font.width;
         s++;
     }
+    PROF_END(PROF_ZONE_WRITE_STRING);
 }
 
 
 
+/* Zeilenpuffer mit einer Farbe füllen (Display erwartet High-Byte zuerst) */
+static RAMFUNC void ST_FillLine(uint16_t color, uint16_t w)
+{
+    uint8_t hi = (uint8_t)(color >> 8), lo = (uint8_t)(color & 0xFF);
+    for (uint16_t i = 0; i < w; ++i) {
+        linebuf[2*i] = hi; linebuf[2*i+1] = lo;
+    }
+}
+
+/* RGB565-Zeile (little endian) byteswappen in linebuf */
+static RAMFUNC void ST_SwapLine(const uint16_t *src, uint16_t w)
+{
+    for (uint16_t i = 0; i < w; ++i) {
+        uint16_t c = src[i];
+        linebuf[2*i] = (uint8_t)(c >> 8);
+        linebuf[2*i+1] = (uint8_t)(c & 0xFF);
+    }
+}
+
 /* Blocking Fill (klein & simpel) – bleibt als Referenz */
 void ST7735_FillRectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
 {
@@ -253,11 +342,8 @@ void ST7735_FillRectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16
 
     ST7735_SetAddressWindow(x, y, x + w - 1, y + h - 1);
 
-    uint8_t hi = (uint8_t)(color >> 8), lo = (uint8_t)(color & 0xFF);
+    ST_FillLine(color, w);
     for (uint16_t row = 0; row < h; row++) {
-        for (uint16_t i = 0; i < w; ++i) {
-            linebuf[2*i] = hi; linebuf[2*i+1] = lo;
-        }
         ST_BeginData();
         HAL_SPI_Transmit(&ST7735_SPI_PORT, linebuf, (uint16_t)(w*2), HAL_MAX_DELAY);
         ST_EndData();
@@ -271,13 +357,11 @@ void ST7735_FillRectangleFast(uint16_t x, uint16_t y, uint16_t w, uint16_t h, ui
     if ((x + w) > ST7735_WIDTH)  w = ST7735_WIDTH - x;
     if ((y + h) > ST7735_HEIGHT) h = ST7735_HEIGHT - y;
 
+    PROF_BEGIN(PROF_ZONE_FILL_RECT);
     ST7735_SetAddressWindow(x, y, x + w - 1, y + h - 1);
 
     /* Zeilenpuffer vorbereiten */
-    uint8_t hi = (uint8_t)(color >> 8), lo = (uint8_t)(color & 0xFF);
-    for (uint16_t i = 0; i < w; ++i) {
-        linebuf[2*i] = hi; linebuf[2*i+1] = lo;
-    }
+    ST_FillLine(color, w);
 
     ST_BeginData(); /* CS LOW, DC DATA */
     for (uint16_t row = 0; row < h; ++row) {
@@ -285,6 +369,7 @@ void ST7735_FillRectangleFast(uint16_t x, uint16_t y, uint16_t w, uint16_t h, ui
         ST_WaitDMA();
     }
     ST_EndData();   /* CS HIGH */
+    PROF_END(PROF_ZONE_FILL_RECT);
 }
 
 // interne Helfer: ohne Select/Unselect (für gebündelte Transfers)
@@ -339,12 +424,7 @@ void ST7735_DrawImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint
 
     ST_BeginData();
     for (uint16_t row = 0; row < h; ++row) {
-        const uint16_t *src = data + (uint32_t)row * w;
-        for (uint16_t i = 0; i < w; ++i) {
-            uint16_t c = src[i];
-            linebuf[2*i] = (uint8_t)(c >> 8);
-            linebuf[2*i+1] = (uint8_t)(c & 0xFF);
-        }
+        ST_SwapLine(data + (uint32_t)row * w, w);
         ST_StartDMA(linebuf, (uint16_t)(w * 2));
         ST_WaitDMA();
     }
@@ -361,3 +441,31 @@ void ST7735_SetGamma(GammaDef gamma)
     ST_WriteCommand(ST7735_GAMSET);
     ST_WriteData8((uint8_t)gamma);
 }
+
+/* 180° drehen (MX/MY invertieren); GRAM-Inhalt danach neu zeichnen.
+   Bei Panels mit XSTART/YSTART verschiebt sich das Bild um den Versatz. */
+void ST7735_SetFlip(bool flip)
+{
+    ST_WriteCommand(ST7735_MADCTL);
+    ST_WriteData8((uint8_t)(ST7735_ROTATION ^ (flip ? (ST7735_MADCTL_MX | ST7735_MADCTL_MY) : 0)));
+}
+
+/* Sleep In/Out: Displayinhalt bleibt im GRAM erhalten.
+   Datenblatt: nach SLPOUT 5 ms bis zum nächsten Kommando, 120 ms bis SLPIN. */
+void ST7735_Sleep(bool sleep)
+{
+    static uint32_t slpout_tick = 0;
+
+    if (!ST7735_IsReady()) return;   // Init läuft noch, schaltet selbst ein
+
+    if (sleep) {
+        while ((HAL_GetTick() - slpout_tick) < 120) { __WFI(); }
+        ST_WriteCommand(ST7735_DISPOFF);
+        ST_WriteCommand(ST7735_SLPIN);
+    } else {
+        ST_WriteCommand(ST7735_SLPOUT);
+        slpout_tick = HAL_GetTick();
+        HAL_Delay(5);
+        ST_WriteCommand(ST7735_DISPON);
+    }
+}
@@ -256,6 +256,9 @@ extern "C" {
 void ST7735_Unselect();
 
 void ST7735_Init(void);
+void ST7735_InitStart(void);
+uint16_t ST7735_InitStep(void);   // Wartezeit in ms bis zum nächsten Schritt, 0 = fertig
+bool ST7735_IsReady(void);
 void ST7735_DrawPixel(uint16_t x, uint16_t y, uint16_t color);
 void ST7735_WriteString(uint16_t x, uint16_t y, const char* str, FontDef font, uint16_t color, uint16_t bgcolor);
 void ST7735_FillRectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
@@ -265,6 +268,8 @@ void ST7735_FillScreenFast(uint16_t color);
 void ST7735_DrawImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* data);
 void ST7735_InvertColors(bool invert);
 void ST7735_SetGamma(GammaDef gamma);
+void ST7735_SetFlip(bool flip);
+void ST7735_Sleep(bool sleep);
 void ST7735_Select(void);
 void ST7735_Unselect(void);
 void ST7735_SetAddressWindow(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1);
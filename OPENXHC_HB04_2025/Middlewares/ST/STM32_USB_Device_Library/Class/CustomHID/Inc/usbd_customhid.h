@@ -76,6 +76,22 @@ extern "C" {
 
 #define CUSTOM_HID_REQ_SET_REPORT            0x09U
 #define CUSTOM_HID_REQ_GET_REPORT            0x01U
+
+#if USBD_CDC_TELEMETRY
+/* Composite: HID (Interface 0) + CDC-ACM (Interface 1 Steuerung, 2 Daten) */
+#define CDC_TLM_CMD_ITF                      0x01U
+#define CDC_TLM_DATA_ITF                     0x02U
+#define CDC_TLM_IN_EP                        0x82U
+#define CDC_TLM_OUT_EP                       0x02U
+#define CDC_TLM_CMD_EP                       0x83U
+#define CDC_TLM_DATA_PACKET_SIZE             64U
+#define CDC_TLM_CMD_PACKET_SIZE              8U
+#define USB_CUSTOM_HID_CDC_CONFIG_DESC_SIZ   100U
+
+#define CDC_TLM_SET_LINE_CODING              0x20U
+#define CDC_TLM_GET_LINE_CODING              0x21U
+#define CDC_TLM_SET_CONTROL_LINE_STATE       0x22U
+#endif /* USBD_CDC_TELEMETRY */
 /**
   * @}
   */
@@ -98,6 +114,15 @@ typedef struct _USBD_CUSTOM_HID_Itf
   int8_t (* DeInit)(void);
   int8_t (* OutEvent)(uint8_t event_idx, uint8_t state);
   int8_t (* SetReport)     (uint8_t *report, uint16_t len);
+  int8_t (* InEvent)(void);
+  uint8_t *(* GetReport)(uint8_t type, uint8_t id, uint16_t *len);  /* NULL -> STALL */
+  /* SET_REPORT direkt in einen Puffer der Anwendung (NULL -> Report_buf + SetReport) */
+  uint8_t *(* SetReportBuf)(uint8_t type, uint8_t id, uint16_t len);
+  void (* SetReportDone)(uint8_t *buf, uint16_t len);
+#if USBD_CDC_TELEMETRY
+  void (* CdcTxDone)(void);   /* Bulk-IN Paket abgeholt (USB-IRQ) */
+  void (* CdcReset)(void);    /* Klasse (de)initialisiert: laufender Bulk-IN verworfen (USB-IRQ) */
+#endif
 
 } USBD_CUSTOM_HID_ItfTypeDef;
 
@@ -107,8 +132,20 @@ typedef struct
   uint32_t             Protocol;
   uint32_t             IdleState;
   uint32_t             AltSetting;
-  uint32_t             IsReportAvailable;
+  uint32_t             IsReportAvailable;  /* 1 = Report_buf, 2 = Puffer aus SetReportBuf */
+  uint8_t              *RxDirect;
+  uint16_t             RxDirectLen;
   CUSTOM_HID_StateTypeDef     state;
+  uint8_t              InFifo[USBD_CUSTOMHID_IN_FIFO_DEPTH][USBD_CUSTOMHID_IN_REPORT_MAX];
+  uint16_t             InFifoLen[USBD_CUSTOMHID_IN_FIFO_DEPTH];
+  uint32_t             InFifoHead;     /* nächster freier Platz */
+  uint32_t             InFifoTail;     /* nächster zu sendender Report */
+#if USBD_CDC_TELEMETRY
+  uint8_t              CdcLineCoding[7];
+  uint8_t              CdcDtr;         /* Terminal geöffnet (SET_CONTROL_LINE_STATE) */
+  uint8_t              CdcTxBusy;
+  uint8_t              CdcRx[CDC_TLM_DATA_PACKET_SIZE];   /* Host->Device wird verworfen */
+#endif
 }
 USBD_CUSTOM_HID_HandleTypeDef;
 /**
@@ -142,6 +179,13 @@ uint8_t USBD_CUSTOM_HID_SendReport(USBD_HandleTypeDef *pdev,
                                    uint8_t *report,
                                    uint16_t len);
 
+uint32_t USBD_CUSTOM_HID_InQueued(USBD_HandleTypeDef *pdev);
+
+#if USBD_CDC_TELEMETRY
+uint8_t USBD_CUSTOM_HID_CdcTransmit(USBD_HandleTypeDef *pdev, uint8_t *buf, uint16_t len);
+uint8_t USBD_CUSTOM_HID_CdcIsOpen(USBD_HandleTypeDef *pdev);
+#endif
+
 
 
 uint8_t  USBD_CUSTOM_HID_RegisterInterface(USBD_HandleTypeDef   *pdev,
@@ -106,6 +106,9 @@ static uint8_t  USBD_CUSTOM_HID_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
 
 static uint8_t  USBD_CUSTOM_HID_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum);
 static uint8_t  USBD_CUSTOM_HID_EP0_RxReady(USBD_HandleTypeDef  *pdev);
+#if USBD_CDC_TELEMETRY
+static uint8_t  USBD_CUSTOM_HID_CdcSetup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+#endif
 /**
   * @}
   */
@@ -114,6 +117,14 @@ static uint8_t  USBD_CUSTOM_HID_EP0_RxReady(USBD_HandleTypeDef  *pdev);
   * @{
   */
 
+/* Klassen-Handle statisch statt über USBD_malloc: die Größe steht zur
+Linkzeit fest, DataIn/DataOut/EP0_RxReady greifen ohne pClassData-Umweg zu.
+pClassData zeigt weiterhin darauf und dient dem Core als "Klasse aktiv". */
+static USBD_CUSTOM_HID_HandleTypeDef CUSTOM_HID_Handle;
+
+_Static_assert(sizeof(USBD_CUSTOM_HID_HandleTypeDef) <= USBD_CUSTOMHID_HANDLE_BUDGET,
+               "USBD_CUSTOM_HID_HandleTypeDef überschreitet USBD_CUSTOMHID_HANDLE_BUDGET");
+
 USBD_ClassTypeDef  USBD_CUSTOM_HID =
 {
   USBD_CUSTOM_HID_Init,
@@ -142,7 +153,7 @@ __ALIGN_BEGIN static uint8_t USBD_CUSTOM_HID_CfgFSDesc[USB_CUSTOM_HID_CONFIG_DES
 		  0x01,	        /* bNumInterfaces */
 		  0x01,	        /* bConfigurationValue */
 		  0x00,	        /* iConfiguration */
-		  0x80,	        /* bmAttributes   (Bus-powered Device) */
+		  0xA0,	        /* bmAttributes   (Bus-powered Device, Remote Wakeup) */
 		  0x32,	        /* bMaxPower   (100 mA) */
 
 		  /* INTERFACE DESCRIPTOR */
@@ -163,7 +174,8 @@ __ALIGN_BEGIN static uint8_t USBD_CUSTOM_HID_CfgFSDesc[USB_CUSTOM_HID_CONFIG_DES
 		  0x00,         /* bCountryCode */
 		  0x01,         /* bNumDescriptors */
 		  0x22,         /* bDescriptorType ( Report ) */
-		  0x2E,0x00,    /* wDescriptorLength ( Report Size ) */
+		  LOBYTE(USBD_CUSTOM_HID_REPORT_DESC_SIZE),
+		  HIBYTE(USBD_CUSTOM_HID_REPORT_DESC_SIZE),  /* wDescriptorLength ( Report Size ) */
 
 		  /* ENDPOINT DESCRIPTOR */
 		  0x07,	        /* bLength */
@@ -171,8 +183,65 @@ __ALIGN_BEGIN static uint8_t USBD_CUSTOM_HID_CfgFSDesc[USB_CUSTOM_HID_CONFIG_DES
 		  0x81,	        /* bEndpointAddress (IN Endpoint 1) */
 		  0x03,	        /* bmAttributes	( Interrupt ) */
 		  0x40, 0x00,	/* wMaxPacketSize   (64 Bytes) */
-		  0x02,	        /* bInterval ( 2 ms )*/
+		  CUSTOM_HID_FS_BINTERVAL,	/* bInterval */
+};
+
+#if USBD_CDC_TELEMETRY
+/* Composite FS Configuration Descriptor: HID wie oben (Interface 0, EP 0x81),
+   dazu CDC-ACM mit IAD (Interface 1: Notify EP 0x83, Interface 2: Bulk 0x02/0x82) */
+__ALIGN_BEGIN static uint8_t USBD_CUSTOM_HID_CDC_CfgFSDesc[USB_CUSTOM_HID_CDC_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+		  /* CONFIG DESCRIPTOR */
+		  0x09,	        /* bLength */
+		  0x02,	        /* bDescriptorType (Configuration)*/
+		  LOBYTE(USB_CUSTOM_HID_CDC_CONFIG_DESC_SIZ),
+		  HIBYTE(USB_CUSTOM_HID_CDC_CONFIG_DESC_SIZ),	/* wTotalLength */
+		  0x03,	        /* bNumInterfaces */
+		  0x01,	        /* bConfigurationValue */
+		  0x00,	        /* iConfiguration */
+		  0xA0,	        /* bmAttributes   (Bus-powered Device, Remote Wakeup) */
+		  0x32,	        /* bMaxPower   (100 mA) */
+
+		  /* HID INTERFACE DESCRIPTOR */
+		  0x09, 0x04, 0x00, 0x00, 0x01, 0x03, 0x00, 0x00, 0x00,
+
+		  /* HID Descriptor */
+		  0x09, 0x21, 0x10, 0x01, 0x00, 0x01, 0x22,
+		  LOBYTE(USBD_CUSTOM_HID_REPORT_DESC_SIZE),
+		  HIBYTE(USBD_CUSTOM_HID_REPORT_DESC_SIZE),
+
+		  /* HID ENDPOINT DESCRIPTOR (IN 1, Interrupt) */
+		  0x07, 0x05, CUSTOM_HID_EPIN_ADDR, 0x03, 0x40, 0x00, CUSTOM_HID_FS_BINTERVAL,
+
+		  /* INTERFACE ASSOCIATION DESCRIPTOR */
+		  0x08,	        /* bLength */
+		  0x0B,	        /* bDescriptorType (IAD) */
+		  CDC_TLM_CMD_ITF, /* bFirstInterface */
+		  0x02,	        /* bInterfaceCount */
+		  0x02, 0x02, 0x01, /* CDC, ACM, AT-Kommandos */
+		  0x00,	        /* iFunction */
+
+		  /* CDC COMMUNICATION INTERFACE */
+		  0x09, 0x04, CDC_TLM_CMD_ITF, 0x00, 0x01, 0x02, 0x02, 0x01, 0x00,
+		  /* Header Functional Descriptor (CDC 1.10) */
+		  0x05, 0x24, 0x00, 0x10, 0x01,
+		  /* Call Management Functional Descriptor */
+		  0x05, 0x24, 0x01, 0x00, CDC_TLM_DATA_ITF,
+		  /* ACM Functional Descriptor (SET/GET_LINE_CODING, SET_CONTROL_LINE_STATE) */
+		  0x04, 0x24, 0x02, 0x02,
+		  /* Union Functional Descriptor */
+		  0x05, 0x24, 0x06, CDC_TLM_CMD_ITF, CDC_TLM_DATA_ITF,
+		  /* Notification Endpoint (Interrupt IN, nie benutzt) */
+		  0x07, 0x05, CDC_TLM_CMD_EP, 0x03, CDC_TLM_CMD_PACKET_SIZE, 0x00, 0xFF,
+
+		  /* CDC DATA INTERFACE */
+		  0x09, 0x04, CDC_TLM_DATA_ITF, 0x00, 0x02, 0x0A, 0x00, 0x00, 0x00,
+		  /* Bulk OUT */
+		  0x07, 0x05, CDC_TLM_OUT_EP, 0x02, CDC_TLM_DATA_PACKET_SIZE, 0x00, 0x00,
+		  /* Bulk IN */
+		  0x07, 0x05, CDC_TLM_IN_EP, 0x02, CDC_TLM_DATA_PACKET_SIZE, 0x00, 0x00,
 };
+#endif /* USBD_CDC_TELEMETRY */
 
 /* USB CUSTOM_HID device HS Configuration Descriptor */
 __ALIGN_BEGIN static uint8_t USBD_CUSTOM_HID_CfgHSDesc[USB_CUSTOM_HID_CONFIG_DESC_SIZ] __ALIGN_END =
@@ -184,7 +253,7 @@ __ALIGN_BEGIN static uint8_t USBD_CUSTOM_HID_CfgHSDesc[USB_CUSTOM_HID_CONFIG_DES
 		  0x01,	        /* bNumInterfaces */
 		  0x01,	        /* bConfigurationValue */
 		  0x00,	        /* iConfiguration */
-		  0x80,	        /* bmAttributes   (Bus-powered Device) */
+		  0xA0,	        /* bmAttributes   (Bus-powered Device, Remote Wakeup) */
 		  0x32,	        /* bMaxPower   (100 mA) */
 
 		  /* INTERFACE DESCRIPTOR */
@@ -205,7 +274,8 @@ __ALIGN_BEGIN static uint8_t USBD_CUSTOM_HID_CfgHSDesc[USB_CUSTOM_HID_CONFIG_DES
 		  0x00,         /* bCountryCode */
 		  0x01,         /* bNumDescriptors */
 		  0x22,         /* bDescriptorType ( Report ) */
-		  0x2E,0x00,    /* wDescriptorLength ( Report Size ) */
+		  LOBYTE(USBD_CUSTOM_HID_REPORT_DESC_SIZE),
+		  HIBYTE(USBD_CUSTOM_HID_REPORT_DESC_SIZE),  /* wDescriptorLength ( Report Size ) */
 
 		  /* ENDPOINT DESCRIPTOR */
 		  0x07,	        /* bLength */
@@ -213,7 +283,7 @@ __ALIGN_BEGIN static uint8_t USBD_CUSTOM_HID_CfgHSDesc[USB_CUSTOM_HID_CONFIG_DES
 		  0x81,	        /* bEndpointAddress (IN Endpoint 1) */
 		  0x03,	        /* bmAttributes	( Interrupt ) */
 		  0x40, 0x00,	/* wMaxPacketSize   (64 Bytes) */
-		  0x02,	        /* bInterval ( 2 ms )*/
+		  CUSTOM_HID_FS_BINTERVAL,	/* bInterval */
 };
 
 /* USB CUSTOM_HID device Other Speed Configuration Descriptor */
@@ -226,7 +296,7 @@ __ALIGN_BEGIN static uint8_t USBD_CUSTOM_HID_OtherSpeedCfgDesc[USB_CUSTOM_HID_CO
 		  0x01,	        /* bNumInterfaces */
 		  0x01,	        /* bConfigurationValue */
 		  0x00,	        /* iConfiguration */
-		  0x80,	        /* bmAttributes   (Bus-powered Device) */
+		  0xA0,	        /* bmAttributes   (Bus-powered Device, Remote Wakeup) */
 		  0x32,	        /* bMaxPower   (100 mA) */
 
 		  /* INTERFACE DESCRIPTOR */
@@ -247,7 +317,8 @@ __ALIGN_BEGIN static uint8_t USBD_CUSTOM_HID_OtherSpeedCfgDesc[USB_CUSTOM_HID_CO
 		  0x00,         /* bCountryCode */
 		  0x01,         /* bNumDescriptors */
 		  0x22,         /* bDescriptorType ( Report ) */
-		  0x2E,0x00,    /* wDescriptorLength ( Report Size ) */
+		  LOBYTE(USBD_CUSTOM_HID_REPORT_DESC_SIZE),
+		  HIBYTE(USBD_CUSTOM_HID_REPORT_DESC_SIZE),  /* wDescriptorLength ( Report Size ) */
 
 		  /* ENDPOINT DESCRIPTOR */
 		  0x07,	        /* bLength */
@@ -255,7 +326,7 @@ __ALIGN_BEGIN static uint8_t USBD_CUSTOM_HID_OtherSpeedCfgDesc[USB_CUSTOM_HID_CO
 		  0x81,	        /* bEndpointAddress (IN Endpoint 1) */
 		  0x03,	        /* bmAttributes	( Interrupt ) */
 		  0x40, 0x00,	/* wMaxPacketSize   (64 Bytes) */
-		  0x02,	        /* bInterval ( 2 ms )*/
+		  CUSTOM_HID_FS_BINTERVAL,	/* bInterval */
 };
 
 /* USB CUSTOM_HID device Configuration Descriptor */
@@ -321,23 +392,39 @@ static uint8_t  USBD_CUSTOM_HID_Init(USBD_HandleTypeDef *pdev,
 
   pdev->ep_out[CUSTOM_HID_EPOUT_ADDR & 0xFU].is_used = 1U;
 
-  pdev->pClassData = USBD_malloc(sizeof(USBD_CUSTOM_HID_HandleTypeDef));
+#if USBD_CDC_TELEMETRY
+  USBD_LL_OpenEP(pdev, CDC_TLM_IN_EP, USBD_EP_TYPE_BULK, CDC_TLM_DATA_PACKET_SIZE);
+  pdev->ep_in[CDC_TLM_IN_EP & 0xFU].is_used = 1U;
+  USBD_LL_OpenEP(pdev, CDC_TLM_OUT_EP, USBD_EP_TYPE_BULK, CDC_TLM_DATA_PACKET_SIZE);
+  pdev->ep_out[CDC_TLM_OUT_EP & 0xFU].is_used = 1U;
+  USBD_LL_OpenEP(pdev, CDC_TLM_CMD_EP, USBD_EP_TYPE_INTR, CDC_TLM_CMD_PACKET_SIZE);
+  pdev->ep_in[CDC_TLM_CMD_EP & 0xFU].is_used = 1U;
+#endif
 
-  if (pdev->pClassData == NULL)
-  {
-    ret = 1U;
-  }
-  else
-  {
-    hhid = (USBD_CUSTOM_HID_HandleTypeDef *) pdev->pClassData;
+  hhid = &CUSTOM_HID_Handle;
+  pdev->pClassData = hhid;
 
-    hhid->state = CUSTOM_HID_IDLE;
-    ((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->Init();
+  hhid->state = CUSTOM_HID_IDLE;
+  hhid->InFifoHead = 0U;
+  hhid->InFifoTail = 0U;
+  ((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->Init();
+
+  /* Prepare Out endpoint to receive 1st packet */
+  USBD_LL_PrepareReceive(pdev, CUSTOM_HID_EPOUT_ADDR, hhid->Report_buf,
+                         USBD_CUSTOMHID_OUTREPORT_BUF_SIZE);
 
-    /* Prepare Out endpoint to receive 1st packet */
-    USBD_LL_PrepareReceive(pdev, CUSTOM_HID_EPOUT_ADDR, hhid->Report_buf,
-                           USBD_CUSTOMHID_OUTREPORT_BUF_SIZE);
+#if USBD_CDC_TELEMETRY
+  /* 115200 8N1 als Vorgabe; die Baudrate hat auf USB keine Bedeutung */
+  static const uint8_t line_coding[7] = { 0x00, 0xC2, 0x01, 0x00, 0x00, 0x00, 0x08 };
+  (void)memcpy(hhid->CdcLineCoding, line_coding, sizeof(line_coding));
+  hhid->CdcDtr = 0U;
+  hhid->CdcTxBusy = 0U;
+  if (((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->CdcReset != NULL)
+  {
+    ((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->CdcReset();
   }
+  USBD_LL_PrepareReceive(pdev, CDC_TLM_OUT_EP, hhid->CdcRx, CDC_TLM_DATA_PACKET_SIZE);
+#endif
 
   return ret;
 }
@@ -360,11 +447,23 @@ static uint8_t  USBD_CUSTOM_HID_DeInit(USBD_HandleTypeDef *pdev,
   USBD_LL_CloseEP(pdev, CUSTOM_HID_EPOUT_ADDR);
   pdev->ep_out[CUSTOM_HID_EPOUT_ADDR & 0xFU].is_used = 0U;
 
-  /* FRee allocated memory */
+#if USBD_CDC_TELEMETRY
+  USBD_LL_CloseEP(pdev, CDC_TLM_IN_EP);
+  pdev->ep_in[CDC_TLM_IN_EP & 0xFU].is_used = 0U;
+  USBD_LL_CloseEP(pdev, CDC_TLM_OUT_EP);
+  pdev->ep_out[CDC_TLM_OUT_EP & 0xFU].is_used = 0U;
+  USBD_LL_CloseEP(pdev, CDC_TLM_CMD_EP);
+  pdev->ep_in[CDC_TLM_CMD_EP & 0xFU].is_used = 0U;
+  if (((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->CdcReset != NULL)
+  {
+    ((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->CdcReset();
+  }
+#endif
+
+  /* Klasse inaktiv; der statische Handle bleibt liegen */
   if (pdev->pClassData != NULL)
   {
     ((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->DeInit();
-    USBD_free(pdev->pClassData);
     pdev->pClassData = NULL;
   }
   return USBD_OK;
@@ -386,6 +485,14 @@ static uint8_t  USBD_CUSTOM_HID_Setup(USBD_HandleTypeDef *pdev,
   uint16_t status_info = 0U;
   uint8_t ret = USBD_OK;
 
+#if USBD_CDC_TELEMETRY
+  if ((req->bmRequest & USB_REQ_TYPE_MASK) == USB_REQ_TYPE_CLASS &&
+      (LOBYTE(req->wIndex) == CDC_TLM_CMD_ITF || LOBYTE(req->wIndex) == CDC_TLM_DATA_ITF))
+  {
+    return USBD_CUSTOM_HID_CdcSetup(pdev, req);
+  }
+#endif
+
   switch (req->bmRequest & USB_REQ_TYPE_MASK)
   {
     case USB_REQ_TYPE_CLASS :
@@ -408,8 +515,45 @@ static uint8_t  USBD_CUSTOM_HID_Setup(USBD_HandleTypeDef *pdev,
           break;
 
         case CUSTOM_HID_REQ_SET_REPORT:
-          hhid->IsReportAvailable = 1U;
-          USBD_CtlPrepareRx(pdev, hhid->Report_buf, req->wLength);
+          /* wValue: High-Byte Report-Typ, Low-Byte Report-ID */
+          if (((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->SetReportBuf != NULL)
+          {
+            pbuf = ((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->SetReportBuf(HIBYTE(req->wValue),
+                                                                                 LOBYTE(req->wValue),
+                                                                                 req->wLength);
+          }
+          if (pbuf != NULL)
+          {
+            /* Datenphase ohne Zwischenkopie direkt in den Puffer der Anwendung */
+            hhid->IsReportAvailable = 2U;
+            hhid->RxDirect = pbuf;
+            hhid->RxDirectLen = req->wLength;
+            USBD_CtlPrepareRx(pdev, pbuf, req->wLength);
+          }
+          else
+          {
+            hhid->IsReportAvailable = 1U;
+            USBD_CtlPrepareRx(pdev, hhid->Report_buf, req->wLength);
+          }
+          break;
+
+        case CUSTOM_HID_REQ_GET_REPORT:
+          /* wValue: High-Byte Report-Typ, Low-Byte Report-ID */
+          if (((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->GetReport != NULL)
+          {
+            pbuf = ((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->GetReport(HIBYTE(req->wValue),
+                                                                              LOBYTE(req->wValue),
+                                                                              &len);
+          }
+          if (pbuf != NULL)
+          {
+            USBD_CtlSendData(pdev, pbuf, MIN(len, req->wLength));
+          }
+          else
+          {
+            USBD_CtlError(pdev, req);
+            ret = USBD_FAIL;
+          }
           break;
 
         default:
@@ -502,23 +646,134 @@ uint8_t USBD_CUSTOM_HID_SendReport(USBD_HandleTypeDef  *pdev,
                                    uint8_t *report,
                                    uint16_t len)
 {
-  USBD_CUSTOM_HID_HandleTypeDef     *hhid = (USBD_CUSTOM_HID_HandleTypeDef *)pdev->pClassData;
+  USBD_CUSTOM_HID_HandleTypeDef     *hhid = &CUSTOM_HID_Handle;
+  uint8_t ret = USBD_OK;
 
   if (pdev->dev_state == USBD_STATE_CONFIGURED)
   {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
     if (hhid->state == CUSTOM_HID_IDLE)
     {
       hhid->state = CUSTOM_HID_BUSY;
       USBD_LL_Transmit(pdev, CUSTOM_HID_EPIN_ADDR, report, len);
     }
+    else if ((hhid->InFifoHead - hhid->InFifoTail) < USBD_CUSTOMHID_IN_FIFO_DEPTH &&
+             len <= USBD_CUSTOMHID_IN_REPORT_MAX)
+    {
+      /* Endpoint belegt: Kopie einreihen, DataIn lädt sie nach */
+      uint32_t slot = hhid->InFifoHead % USBD_CUSTOMHID_IN_FIFO_DEPTH;
+      (void)memcpy(hhid->InFifo[slot], report, len);
+      hhid->InFifoLen[slot] = len;
+      hhid->InFifoHead++;
+    }
     else
     {
-      return USBD_BUSY;
+      ret = USBD_BUSY;
     }
+
+    __set_PRIMASK(primask);
+  }
+  return ret;
+}
+
+/**
+  * @brief  USBD_CUSTOM_HID_InQueued
+  *         Number of reports in flight or waiting in the IN FIFO
+  * @param  pdev: device instance
+  * @retval count
+  */
+uint32_t USBD_CUSTOM_HID_InQueued(USBD_HandleTypeDef *pdev)
+{
+  USBD_CUSTOM_HID_HandleTypeDef     *hhid = (USBD_CUSTOM_HID_HandleTypeDef *)pdev->pClassData;
+
+  if (hhid == NULL || pdev->dev_state != USBD_STATE_CONFIGURED)
+  {
+    return 0U;
+  }
+  return (hhid->InFifoHead - hhid->InFifoTail) + ((hhid->state == CUSTOM_HID_BUSY) ? 1U : 0U);
+}
+
+#if USBD_CDC_TELEMETRY
+/**
+  * @brief  USBD_CUSTOM_HID_CdcSetup
+  *         CDC-ACM class requests (interfaces 1 and 2)
+  * @param  pdev: device instance
+  * @param  req: usb request
+  * @retval status
+  */
+static uint8_t  USBD_CUSTOM_HID_CdcSetup(USBD_HandleTypeDef *pdev,
+                                         USBD_SetupReqTypedef *req)
+{
+  USBD_CUSTOM_HID_HandleTypeDef *hhid = (USBD_CUSTOM_HID_HandleTypeDef *)pdev->pClassData;
+
+  switch (req->bRequest)
+  {
+    case CDC_TLM_SET_LINE_CODING:
+      /* Nur speichern (GET_LINE_CODING), Datenphase direkt in den Handle */
+      USBD_CtlPrepareRx(pdev, hhid->CdcLineCoding, MIN(req->wLength, sizeof(hhid->CdcLineCoding)));
+      break;
+
+    case CDC_TLM_GET_LINE_CODING:
+      USBD_CtlSendData(pdev, hhid->CdcLineCoding, MIN(req->wLength, sizeof(hhid->CdcLineCoding)));
+      break;
+
+    case CDC_TLM_SET_CONTROL_LINE_STATE:
+      hhid->CdcDtr = (uint8_t)(req->wValue & 0x01U);
+      break;
+
+    default:
+      /* SEND_BREAK u.a.: ohne Wirkung bestätigen */
+      break;
   }
   return USBD_OK;
 }
 
+/**
+  * @brief  USBD_CUSTOM_HID_CdcTransmit
+  *         Send one bulk IN packet on the CDC data interface
+  * @param  pdev: device instance
+  * @param  buf: data (copied to the PMA on start)
+  * @param  len: length, at most CDC_TLM_DATA_PACKET_SIZE
+  * @retval USBD_OK, USBD_BUSY
+  */
+uint8_t USBD_CUSTOM_HID_CdcTransmit(USBD_HandleTypeDef *pdev, uint8_t *buf, uint16_t len)
+{
+  USBD_CUSTOM_HID_HandleTypeDef     *hhid = (USBD_CUSTOM_HID_HandleTypeDef *)pdev->pClassData;
+  uint8_t ret = USBD_BUSY;
+
+  if (pdev->dev_state != USBD_STATE_CONFIGURED || hhid == NULL || len > CDC_TLM_DATA_PACKET_SIZE)
+  {
+    return USBD_FAIL;
+  }
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if (hhid->CdcTxBusy == 0U)
+  {
+    hhid->CdcTxBusy = 1U;
+    USBD_LL_Transmit(pdev, CDC_TLM_IN_EP, buf, len);
+    ret = USBD_OK;
+  }
+  __set_PRIMASK(primask);
+  return ret;
+}
+
+/**
+  * @brief  USBD_CUSTOM_HID_CdcIsOpen
+  *         Host has the serial port open (DTR set)
+  * @param  pdev: device instance
+  * @retval 1 = open
+  */
+uint8_t USBD_CUSTOM_HID_CdcIsOpen(USBD_HandleTypeDef *pdev)
+{
+  USBD_CUSTOM_HID_HandleTypeDef     *hhid = (USBD_CUSTOM_HID_HandleTypeDef *)pdev->pClassData;
+
+  return (pdev->dev_state == USBD_STATE_CONFIGURED && hhid != NULL && hhid->CdcDtr) ? 1U : 0U;
+}
+#endif /* USBD_CDC_TELEMETRY */
+
 /**
   * @brief  USBD_CUSTOM_HID_GetFSCfgDesc
   *         return FS configuration descriptor
@@ -528,8 +783,13 @@ uint8_t USBD_CUSTOM_HID_SendReport(USBD_HandleTypeDef  *pdev,
   */
 static uint8_t  *USBD_CUSTOM_HID_GetFSCfgDesc(uint16_t *length)
 {
+#if USBD_CDC_TELEMETRY
+  *length = sizeof(USBD_CUSTOM_HID_CDC_CfgFSDesc);
+  return USBD_CUSTOM_HID_CDC_CfgFSDesc;
+#else
   *length = sizeof(USBD_CUSTOM_HID_CfgFSDesc);
   return USBD_CUSTOM_HID_CfgFSDesc;
+#endif
 }
 
 /**
@@ -568,9 +828,41 @@ static uint8_t  *USBD_CUSTOM_HID_GetOtherSpeedCfgDesc(uint16_t *length)
 static uint8_t  USBD_CUSTOM_HID_DataIn(USBD_HandleTypeDef *pdev,
                                        uint8_t epnum)
 {
-  /* Ensure that the FIFO is empty before a new transfer, this condition could
-  be caused by  a new transfer before the end of the previous transfer */
-  ((USBD_CUSTOM_HID_HandleTypeDef *)pdev->pClassData)->state = CUSTOM_HID_IDLE;
+  USBD_CUSTOM_HID_HandleTypeDef     *hhid = &CUSTOM_HID_Handle;
+
+#if USBD_CDC_TELEMETRY
+  if (epnum == (CDC_TLM_IN_EP & 0x7FU))
+  {
+    hhid->CdcTxBusy = 0U;
+    if (((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->CdcTxDone != NULL)
+    {
+      ((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->CdcTxDone();
+    }
+    return USBD_OK;
+  }
+  if (epnum == (CDC_TLM_CMD_EP & 0x7FU))
+  {
+    return USBD_OK;
+  }
+#endif
+
+  /* Nächsten Report aus der FIFO sofort bereitstellen: der Host holt ihn im
+  folgenden Frame ab. Sonst ist der Endpoint wieder frei. */
+  if (hhid->InFifoHead != hhid->InFifoTail)
+  {
+    uint32_t slot = hhid->InFifoTail % USBD_CUSTOMHID_IN_FIFO_DEPTH;
+    hhid->InFifoTail++;
+    USBD_LL_Transmit(pdev, CUSTOM_HID_EPIN_ADDR, hhid->InFifo[slot], hhid->InFifoLen[slot]);
+  }
+  else
+  {
+    hhid->state = CUSTOM_HID_IDLE;
+  }
+
+  if (((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->InEvent != NULL)
+  {
+    ((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->InEvent();
+  }
 
   return USBD_OK;
 }
@@ -586,7 +878,16 @@ static uint8_t  USBD_CUSTOM_HID_DataOut(USBD_HandleTypeDef *pdev,
                                         uint8_t epnum)
 {
 
-  USBD_CUSTOM_HID_HandleTypeDef     *hhid = (USBD_CUSTOM_HID_HandleTypeDef *)pdev->pClassData;
+  USBD_CUSTOM_HID_HandleTypeDef     *hhid = &CUSTOM_HID_Handle;
+
+#if USBD_CDC_TELEMETRY
+  if (epnum == CDC_TLM_OUT_EP)
+  {
+    /* Telemetrie ist nur Device->Host: Daten verwerfen, weiter annehmen */
+    USBD_LL_PrepareReceive(pdev, CDC_TLM_OUT_EP, hhid->CdcRx, CDC_TLM_DATA_PACKET_SIZE);
+    return USBD_OK;
+  }
+#endif
 
   ((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->OutEvent(hhid->Report_buf[0],
                                                             hhid->Report_buf[1]);
@@ -605,9 +906,14 @@ static uint8_t  USBD_CUSTOM_HID_DataOut(USBD_HandleTypeDef *pdev,
   */
 static uint8_t  USBD_CUSTOM_HID_EP0_RxReady(USBD_HandleTypeDef *pdev)
 {
-  USBD_CUSTOM_HID_HandleTypeDef     *hhid = (USBD_CUSTOM_HID_HandleTypeDef*)pdev->pClassData;
+  USBD_CUSTOM_HID_HandleTypeDef     *hhid = &CUSTOM_HID_Handle;
 
-  if (hhid->IsReportAvailable == 1U)
+  if (hhid->IsReportAvailable == 2U)
+  {
+    ((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->SetReportDone(hhid->RxDirect, hhid->RxDirectLen);
+    hhid->IsReportAvailable = 0U;
+  }
+  else if (hhid->IsReportAvailable == 1U)
   {
     // *** HIER DIE SetReport CALLBACK AUFRUFEN: ***
     if (((USBD_CUSTOM_HID_ItfTypeDef *)pdev->pUserData)->SetReport != NULL)
@@ -27,6 +27,11 @@
 #include "usbd_customhid.h"  // deklariert USBD_CUSTOM_HID_ReceivePacket()
 #include "usbd_core.h"
 #include "xhc_integration.h"
+#include "diag.h"
+#include "defer.h"
+#include "dwt.h"
+#include "telemetry.h"
+#include "power.h"
 
 
 #ifndef __USB_DEVICE__H
@@ -44,29 +49,32 @@ extern USBD_HandleTypeDef hUsbDeviceFS;
 
 /* USER CODE BEGIN PV */
 /* Private variables ---------------------------------------------------------*/
-#define XHC_OUT_MAX_LEN   64u            // Größe eines Host->Device Reports
-#define XHC_RX_RING_SIZE  8u             // Anzahl gepufferter Reports (2..16)
 #define XHC_FEAT_MAX_LEN  USBD_CUSTOMHID_OUTREPORT_BUF_SIZE
 
+#if (XHC_RX_RING_SIZE & (XHC_RX_RING_SIZE - 1u)) != 0u
+#error "XHC_RX_RING_SIZE muss eine Zweierpotenz sein"
+#endif
+#define XHC_RX_RING_MASK  (XHC_RX_RING_SIZE - 1u)
+
 // Global counter nur für Display-Debug
 volatile uint32_t debug_setreport_calls = 0;
 volatile uint32_t debug_outevent_calls = 0;
 
-
-typedef struct {
-    uint16_t len;
-    uint8_t  data[XHC_OUT_MAX_LEN];
-} xhc_rx_item_t;
-
-static volatile uint16_t   rx_head = 0;     // schreibt der USB-IRQ
-static volatile uint16_t   rx_tail = 0;     // liest die Anwendung
-static volatile uint32_t   rx_dropped = 0;  // Statistik: überlaufene Pakete
+/* Single-Producer (USB-IRQ) / Single-Consumer (PendSV, xhc_rx_work).
+   head/tail laufen frei und werden nur beim Zugriff maskiert,
+   head - tail ist damit immer der Füllstand. */
+static volatile uint32_t   rx_head = 0;       // schreibt nur der USB-IRQ
+static volatile uint32_t   rx_tail = 0;       // schreibt nur der Consumer (PendSV)
+static volatile uint32_t   rx_dropped = 0;    // Statistik: überlaufene Pakete
+static volatile uint32_t   rx_highwater = 0;  // Statistik: maximaler Füllstand
 static xhc_rx_item_t       rx_ring[XHC_RX_RING_SIZE];
 
-/* Hilfs-Makros */
-#define RING_NEXT(i)  (uint16_t)(((i) + 1u) % XHC_RX_RING_SIZE)
-#define RING_EMPTY()  (rx_head == rx_tail)
-#define RING_FULL()   (RING_NEXT(rx_head) == rx_tail)
+/* EP0-Schnellpfad für Report 0x06: Datenphase direkt in den nächsten Ringslot */
+#define XHC_CHUNK_REPORT_LEN  8u   // Report ID + 7 Byte Chunk
+static xhc_rx_item_t      *rx_fast_slot = NULL;   // reserviert im SETUP, veröffentlicht in RxReady
+static uint32_t            rx_fast_head = 0;      // Ringindex der Reservierung
+static uint32_t            ep0_setup_cycles = 0;  // DWT: SETUP des laufenden Chunks
+static xhc_ep0_stats_t     ep0_stats = { .interval_min_us = UINT32_MAX };
 /* USER CODE END PV */
 
 /** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
@@ -86,17 +94,35 @@ static xhc_rx_item_t       rx_ring[XHC_RX_RING_SIZE];
 /* USER CODE BEGIN PRIVATE_TYPES */
 /* --------- API für Anwendung / Debug --------- */
 
+/* Ältestes Paket ohne Kopie ansehen; NULL wenn leer. Gültig bis XHC_RX_Commit(). */
+const xhc_rx_item_t *XHC_RX_Peek(void)
+{
+    uint32_t tail = rx_tail;
+
+    if (rx_head == tail) return NULL;
+
+    __DMB();   // Slot-Inhalt erst nach dem veröffentlichten head lesen
+    return &rx_ring[tail & XHC_RX_RING_MASK];
+}
+
+/* Mit XHC_RX_Peek() angesehenes Paket freigeben */
+void XHC_RX_Commit(void)
+{
+    __DMB();   // Slot fertig gelesen, bevor der Producer ihn wieder beschreibt
+    rx_tail = rx_tail + 1u;
+}
+
 uint8_t XHC_RX_TryPop(uint8_t *dst, uint16_t *io_len)
 {
-    if (RING_EMPTY()) return 0;
+    const xhc_rx_item_t *item = XHC_RX_Peek();
+    if (!item) return 0;
 
-    uint16_t idx = rx_tail;
-    uint16_t n   = rx_ring[idx].len;
+    uint16_t n = item->len;
 
     if (dst && io_len && *io_len >= n) {
-        memcpy(dst, rx_ring[idx].data, n);
+        memcpy(dst, item->data, n);
         *io_len = n;
-        rx_tail = RING_NEXT(rx_tail);
+        XHC_RX_Commit();
         return 1;
     }
 
@@ -106,22 +132,32 @@ uint8_t XHC_RX_TryPop(uint8_t *dst, uint16_t *io_len)
     return 0;
 }
 
-uint32_t XHC_RX_Count(void){ return (rx_head>=rx_tail)? (rx_head-rx_tail):(XHC_RX_RING_SIZE-(rx_tail-rx_head)); }
+uint32_t XHC_RX_Count(void){ return rx_head - rx_tail; }
 uint32_t XHC_RX_Dropped(void){ return rx_dropped; }
+uint32_t XHC_RX_HighWater(void){ return rx_highwater; }
 
-/* Helper: OUT-EP nach Empfang wieder scharf schalten */
+/* Producer: nur aus dem USB-IRQ */
 static inline void XHC_Push_(const uint8_t *buf, uint16_t len)
 {
     if (len > XHC_FEAT_MAX_LEN) len = XHC_FEAT_MAX_LEN;
 
-    if (!RING_FULL()) {
-        uint16_t idx = rx_head;
-        rx_ring[idx].len = len;
-        memcpy(rx_ring[idx].data, buf, len);
-        rx_head = RING_NEXT(rx_head);
-    } else {
+    uint32_t head = rx_head;
+    uint32_t fill = head - rx_tail;
+
+    /* Voll, oder der nächste Slot ist für die EP0-Datenphase reserviert */
+    if (fill >= XHC_RX_RING_SIZE || rx_fast_slot != NULL) {
         rx_dropped++;
+        return;
     }
+
+    xhc_rx_item_t *item = &rx_ring[head & XHC_RX_RING_MASK];
+    item->len = len;
+    memcpy(item->data, buf, len);
+
+    __DMB();   // Slot-Inhalt sichtbar, bevor head ihn freigibt
+    rx_head = head + 1u;
+
+    if (fill + 1u > rx_highwater) rx_highwater = fill + 1u;
 }
 /* USER CODE END PRIVATE_TYPES */
 
@@ -188,6 +224,11 @@ __ALIGN_BEGIN static uint8_t CUSTOM_HID_ReportDesc_FS[USBD_CUSTOM_HID_REPORT_DES
 	    0x95,0x07, 				/* Report Count (7) */
 	    0x75,0x08, 				/* Report Size (8) */
 	    0xB1,0x06, 				/* Feature (Data,Var,Rel,NWrp,Lin,Pref,NNul,NVol,Bit) */
+
+	    0x85,0x07, 				/* Report ID (7) - Diagnose */
+	    0x09,0x02, 				/* Usage (Vendor-Defined 2) */
+	    0x95,0x3F, 				/* Report Count (63) */
+	    0xB1,0x02, 				/* Feature (Data,Var,Abs,NWrp,Lin,Pref,NNul,NVol,Bit) */
   /* USER CODE END 0 */
   0xC0    /*     END_COLLECTION	             */
 };
@@ -222,6 +263,10 @@ static int8_t CUSTOM_HID_Init_FS(void);
 static int8_t CUSTOM_HID_DeInit_FS(void);
 static int8_t CUSTOM_HID_OutEvent_FS(uint8_t event_idx, uint8_t state);
 static int8_t CUSTOM_HID_SetReport_FS(uint8_t *report, uint16_t len);
+static int8_t CUSTOM_HID_InEvent_FS(void);
+static uint8_t *CUSTOM_HID_GetReport_FS(uint8_t type, uint8_t id, uint16_t *len);
+static uint8_t *CUSTOM_HID_SetReportBuf_FS(uint8_t type, uint8_t id, uint16_t len);
+static void CUSTOM_HID_SetReportDone_FS(uint8_t *buf, uint16_t len);
 
 /**
   * @}
@@ -234,6 +279,14 @@ USBD_CUSTOM_HID_ItfTypeDef USBD_CustomHID_fops_FS =
   CUSTOM_HID_DeInit_FS,
   CUSTOM_HID_OutEvent_FS,
   CUSTOM_HID_SetReport_FS,
+  CUSTOM_HID_InEvent_FS,
+  CUSTOM_HID_GetReport_FS,
+  CUSTOM_HID_SetReportBuf_FS,
+  CUSTOM_HID_SetReportDone_FS,
+#if USBD_CDC_TELEMETRY
+  telemetry_tx_done,
+  telemetry_reset,
+#endif
 };
 
 /** @defgroup USBD_CUSTOM_HID_Private_Functions USBD_CUSTOM_HID_Private_Functions
@@ -250,6 +303,7 @@ USBD_CUSTOM_HID_ItfTypeDef USBD_CustomHID_fops_FS =
 static int8_t CUSTOM_HID_Init_FS(void)
 {
   /* USER CODE BEGIN 4 */
+  rx_fast_slot = NULL;   // Reset mitten in einer Datenphase: Reservierung verwerfen
 
   return (USBD_OK);
   /* USER CODE END 4 */
@@ -262,6 +316,7 @@ static int8_t CUSTOM_HID_Init_FS(void)
 static int8_t CUSTOM_HID_DeInit_FS(void)
 {
   /* USER CODE BEGIN 5 */
+  rx_fast_slot = NULL;
   return (USBD_OK);
   /* USER CODE END 5 */
 }
@@ -321,14 +376,95 @@ static int8_t USBD_CUSTOM_HID_SendReport_FS(uint8_t *report, uint16_t len)
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
+/**
+  * @brief  SETUP eines SET_REPORT (USB-IRQ): Report 0x06 ohne Zwischenkopie
+  *         direkt in den nächsten freien Ringslot empfangen
+  * @retval Zielpuffer oder NULL (Report_buf + CUSTOM_HID_SetReport_FS)
+  */
+static uint8_t *CUSTOM_HID_SetReportBuf_FS(uint8_t type, uint8_t id, uint16_t len)
+{
+  if (type != 0x03 || id != 0x06 || len != XHC_CHUNK_REPORT_LEN) return NULL;
+
+  uint32_t head = rx_head;
+  if (head - rx_tail >= XHC_RX_RING_SIZE) return NULL;   // voll: langsamer Pfad zählt den Verlust
+
+  uint32_t now = dwt_cycles();
+  if (ep0_stats.chunks) {
+    ep0_stats.interval_last_us = dwt_to_us(now - ep0_setup_cycles);
+    if (ep0_stats.interval_last_us < ep0_stats.interval_min_us) ep0_stats.interval_min_us = ep0_stats.interval_last_us;
+  }
+  ep0_setup_cycles = now;
+
+  /* Bis zur Datenphase verwirft XHC_Push_() (Interrupt-OUT), damit der Slot
+     nicht doppelt belegt und vorzeitig veröffentlicht wird */
+  rx_fast_head = head;
+  rx_fast_slot = &rx_ring[head & XHC_RX_RING_MASK];
+  return rx_fast_slot->data;
+}
+
+/**
+  * @brief  Neues SETUP auf EP0 (USB-IRQ): eine offene Reservierung gibt den
+  *         Slot frei, ihre Datenphase kommt nicht mehr (SETUP bricht sie ab)
+  */
+void XHC_EP0_Setup(void)
+{
+  if (rx_fast_slot == NULL) return;
+  rx_fast_slot = NULL;
+  ep0_stats.aborted++;
+}
+
+/**
+  * @brief  Datenphase des Schnellpfads fertig (USB-IRQ): Slot veröffentlichen
+  */
+static void CUSTOM_HID_SetReportDone_FS(uint8_t *buf, uint16_t len)
+{
+  xhc_rx_item_t *item = rx_fast_slot;
+  if (item == NULL || buf != item->data) return;
+  rx_fast_slot = NULL;
+
+  uint32_t head = rx_fast_head;
+  if (rx_head != head) return;   // darf nicht vorkommen: nur den reservierten Slot veröffentlichen
+  item->len = len;
+  __DMB();   // Slot-Inhalt sichtbar, bevor head ihn freigibt
+  rx_head = head + 1u;
+
+  uint32_t fill = head + 1u - rx_tail;
+  if (fill > rx_highwater) rx_highwater = fill;
+
+  ep0_stats.chunks++;
+  ep0_stats.turnaround_last_us = dwt_to_us(dwt_cycles() - ep0_setup_cycles);
+  if (ep0_stats.turnaround_last_us > ep0_stats.turnaround_max_us) ep0_stats.turnaround_max_us = ep0_stats.turnaround_last_us;
+
+  defer_post(DEFER_RX);
+}
+
+/* EP0-Statistik (Kopie) */
+void XHC_EP0_GetStats(xhc_ep0_stats_t *out)
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  *out = ep0_stats;
+  __set_PRIMASK(primask);
+  if (out->interval_min_us == UINT32_MAX) out->interval_min_us = 0;
+}
+
 static int8_t CUSTOM_HID_SetReport_FS(uint8_t *report, uint16_t len)
 {
   /* USER CODE BEGIN 7 */
   /* XHC HB04 Integration */
   if (len >= 8 && report[0] == 0x06)
   {
-    /* Report ID 0x06 - Host→Device Kommunikation für XHC */
-    xhc_receive_data(&report[1]);  // Überspringe Report ID
+    /* Report ID 0x06 - Host→Device Kommunikation für XHC (langsamer Pfad:
+       abweichende Länge oder Ring voll). Nur puffern, dekodiert wird im PendSV. */
+    ep0_stats.slow_reports++;
+    XHC_Push_(report, 8u);
+    defer_post(DEFER_RX);
+    return USBD_OK;
+  }
+
+  if (report[0] == DIAG_REPORT_ID)
+  {
+    diag_set_report(report, len);
     return USBD_OK;
   }
 
@@ -336,6 +472,38 @@ static int8_t CUSTOM_HID_SetReport_FS(uint8_t *report, uint16_t len)
   return (USBD_OK);
 }
 
+/**
+  * @brief  IN-Report wurde vom Host abgeholt (Endpoint wieder frei)
+  * @retval USBD_OK
+  */
+static int8_t CUSTOM_HID_InEvent_FS(void)
+{
+  xhc_in_complete();
+  power_in_complete();
+  return (USBD_OK);
+}
+
+/**
+  * @brief  GET_REPORT vom Host (USB-IRQ)
+  * @param  type: Report-Typ (1 = Input, 3 = Feature)
+  * @param  id: Report-ID
+  * @param  len: Länge des gelieferten Reports
+  * @retval Report-Puffer oder NULL (STALL)
+  */
+static uint8_t *CUSTOM_HID_GetReport_FS(uint8_t type, uint8_t id, uint16_t *len)
+{
+  if (type == 0x03 && id == DIAG_REPORT_ID)
+  {
+    return diag_get_report(len);
+  }
+  if (type == 0x01 && id == 0x04)
+  {
+    /* Aktueller Eingabezustand, ohne auf den nächsten IN-Report zu warten */
+    return xhc_get_input_report(len);
+  }
+  return NULL;
+}
+
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 /**
   * @}
@@ -50,9 +50,8 @@
   */
 
 /* USER CODE BEGIN EXPORTED_DEFINES */
- uint8_t  XHC_RX_TryPop(uint8_t *dst, uint16_t *io_len);
- uint32_t XHC_RX_Count(void);
- uint32_t XHC_RX_Dropped(void);
+#define XHC_OUT_MAX_LEN   64u            // Größe eines Host->Device Reports
+#define XHC_RX_RING_SIZE  8u             // Anzahl gepufferter Reports (Zweierpotenz, 2..16)
 /* USER CODE END EXPORTED_DEFINES */
 
 /**
@@ -65,7 +64,21 @@
   */
 
 /* USER CODE BEGIN EXPORTED_TYPES */
-
+typedef struct {
+    uint16_t len;
+    uint8_t  data[XHC_OUT_MAX_LEN];
+} xhc_rx_item_t;
+
+/* EP0-Statistik für Report 0x06 (SET_REPORT Chunks) */
+typedef struct {
+    uint32_t chunks;             // über den Schnellpfad empfangen
+    uint32_t slow_reports;       // 0x06 über Report_buf + SetReport
+    uint32_t turnaround_last_us; // SETUP -> Datenphase fertig
+    uint32_t turnaround_max_us;
+    uint32_t interval_last_us;   // SETUP -> nächstes SETUP
+    uint32_t interval_min_us;
+    uint32_t aborted;            // Datenphase durch ein neues SETUP abgebrochen
+} xhc_ep0_stats_t;
 /* USER CODE END EXPORTED_TYPES */
 
 /**
@@ -107,7 +120,15 @@ extern USBD_CUSTOM_HID_ItfTypeDef USBD_CustomHID_fops_FS;
   */
 
 /* USER CODE BEGIN EXPORTED_FUNCTIONS */
-
+/* Empfangspuffer (SPSC: Producer USB-IRQ, Consumer PendSV: xhc_rx_work über DEFER_RX) */
+const xhc_rx_item_t *XHC_RX_Peek(void);
+void     XHC_RX_Commit(void);
+uint8_t  XHC_RX_TryPop(uint8_t *dst, uint16_t *io_len);
+uint32_t XHC_RX_Count(void);
+uint32_t XHC_RX_Dropped(void);
+uint32_t XHC_RX_HighWater(void);
+void     XHC_EP0_GetStats(xhc_ep0_stats_t *out);
+void     XHC_EP0_Setup(void);   // jedes SETUP auf EP0, vor der Auswertung (USB-IRQ)
 /* USER CODE END EXPORTED_FUNCTIONS */
 
 /**
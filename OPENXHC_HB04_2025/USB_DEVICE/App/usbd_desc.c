@@ -149,9 +149,15 @@ __ALIGN_BEGIN uint8_t USBD_FS_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END =
 	    0x12, 	/* bLength 		*/
 	    0x01, 	/* bDescriptorType      */
 	    0x10,0x01, 	/* bcdUSB 		*/
+#if USBD_CDC_TELEMETRY
+	    0xEF, 	/* bDeviceClass: Misc (Interface Association) */
+	    0x02, 	/* bDeviceSubClass 	*/
+	    0x01, 	/* bDeviceProtocol 	*/
+#else
 	    0x00, 	/* bDeviceClass 	*/
 	    0x00, 	/* bDeviceSubClass 	*/
 	    0x00, 	/* bDeviceProtocol 	*/
+#endif
 	    0x40, 	/* bMaxPacketSize0 	*/
 	    0xCE,0x10, 	/* idVendor 		*/
 	    0x70,0xEB, 	/* idProduct 		*/
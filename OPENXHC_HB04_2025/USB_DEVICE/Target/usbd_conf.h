@@ -62,7 +62,17 @@
   */
 
 /*---------- -----------*/
+/* Optionales Composite-Gerät: zusätzlich CDC-ACM für Telemetrie (telemetry.c).
+   HID bleibt Interface 0 mit unveränderten Endpoints und Timing. */
+#ifndef USBD_CDC_TELEMETRY
+#define USBD_CDC_TELEMETRY     0
+#endif
+/*---------- -----------*/
+#if USBD_CDC_TELEMETRY
+#define USBD_MAX_NUM_INTERFACES     3
+#else
 #define USBD_MAX_NUM_INTERFACES     1
+#endif
 /*---------- -----------*/
 #define USBD_MAX_NUM_CONFIGURATION     1
 /*---------- -----------*/
@@ -74,9 +84,28 @@
 /*---------- -----------*/
 #define USBD_CUSTOMHID_OUTREPORT_BUF_SIZE     64
 /*---------- -----------*/
-#define USBD_CUSTOM_HID_REPORT_DESC_SIZE     46
+#define USBD_CUSTOM_HID_REPORT_DESC_SIZE     54
+/*---------- -----------*/
+/* Report-FIFO vor dem IN-Endpoint: weitere Reports werden in der
+   DataIn-Completion sofort nachgeladen (aufeinanderfolgende Frames) */
+#define USBD_CUSTOMHID_IN_FIFO_DEPTH     4
+#define USBD_CUSTOMHID_IN_REPORT_MAX     8
+/*---------- -----------*/
+/* RAM-Budget für den statischen Klassen-Handle (usbd_customhid.c prüft per
+   _Static_assert); HID allein ~140 Byte, mit CDC-Telemetrie ~216 Byte */
+#define USBD_CUSTOMHID_HANDLE_BUDGET     256
 /*---------- -----------*/
-#define CUSTOM_HID_FS_BINTERVAL     0x5
+/* Low-Latency-Modus je Maschine: 1 ms Polling, kein Software-Rate-Limit.
+   Reportformat bleibt unverändert (LinuxCNC xhc-hb04). */
+#ifndef XHC_LOW_LATENCY
+#define XHC_LOW_LATENCY     0
+#endif
+/*---------- -----------*/
+#if XHC_LOW_LATENCY
+#define CUSTOM_HID_FS_BINTERVAL     0x1
+#else
+#define CUSTOM_HID_FS_BINTERVAL     0x2
+#endif
 
 /****************************************/
 /* #define for FS and HS identification */
@@ -93,11 +122,8 @@
 
 /* Memory management macros */
 
-/** Alias for memory allocation. */
-#define USBD_malloc         (uint32_t *)USBD_static_malloc
-
-/** Alias for memory release. */
-#define USBD_free           USBD_static_free
+/* Kein USBD_malloc/USBD_free: der Klassen-Handle liegt statisch in
+   usbd_customhid.c (siehe USBD_CUSTOMHID_HANDLE_BUDGET) */
 
 /** Alias for memory set. */
 #define USBD_memset         /* Not used */
@@ -108,10 +134,6 @@
 /** Alias for delay. */
 #define USBD_Delay          HAL_Delay
 
-/* For footprint reasons and since only one allocation is handled in the HID class
-   driver, the malloc/free is changed into a static allocation method */
-void *USBD_static_malloc(uint32_t size);
-void USBD_static_free(void *p);
 
 /* DEBUG macros */
 
@@ -0,0 +1,102 @@
+/*
+ * debounce_bench.c
+ *
+ *  Host-Benchmark für Core/Src/debounce.c: 32 Tasten mit zufälligem
+ *  Prellen, gemessen wird die Zeit je Abtastung (alle 32 Tasten).
+ *
+ *  Aufruf:  debounce_bench [abtastungen]
+ *  Mit anderem Schwellwert:  make clean all SAMPLES=4
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "debounce.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+/* Tastenverlauf: Prellphase nach jedem Wechsel, dann stabil */
+typedef struct {
+    uint32_t raw;
+    uint32_t bounce_left[32];
+    uint32_t hold_left[32];
+    uint32_t target;   // logischer Zustand nach dem Prellen
+} keysim_t;
+
+static uint32_t rng = 12345;
+static uint32_t rnd(void) { rng = rng * 1664525u + 1013904223u; return rng >> 8; }
+
+static uint32_t keysim_step(keysim_t *k, uint32_t *transitions) {
+    for (int i = 0; i < 32; i++) {
+        uint32_t bit = 1u << i;
+        if (k->bounce_left[i]) {
+            k->bounce_left[i]--;
+            k->raw = (rnd() & 1) ? (k->raw | bit) : (k->raw & ~bit);
+            if (!k->bounce_left[i]) k->raw = (k->raw & ~bit) | (k->target & bit);
+        } else if (k->hold_left[i]) {
+            k->hold_left[i]--;
+        } else {
+            /* neuer Wechsel: 0..5 Abtastungen Prellen, danach 50..500 stabil */
+            k->target ^= bit;
+            k->bounce_left[i] = rnd() % 6;
+            k->hold_left[i] = 50 + rnd() % 450;
+            (*transitions)++;
+            if (!k->bounce_left[i]) k->raw = (k->raw & ~bit) | (k->target & bit);
+        }
+    }
+    return k->raw;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 10000000u;
+
+    /* Eingangsfolge vorab erzeugen, damit nur der Debouncer gemessen wird */
+    uint32_t *seq = malloc(n * sizeof(*seq));
+    if (!seq) return 1;
+    keysim_t k = {0};
+    uint32_t transitions = 0;
+    for (uint32_t i = 0; i < n; i++) seq[i] = keysim_step(&k, &transitions);
+
+    debounce_t d;
+    debounce_init(&d);
+    uint32_t presses = 0, releases = 0, sink = 0;
+
+    uint64_t t0 = now_ns();
+#ifdef HAVE_TSC
+    uint64_t c0 = __rdtsc();
+#endif
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t p, r;
+        sink ^= debounce_sample(&d, seq[i], &p, &r);
+        presses += (uint32_t)__builtin_popcount(p);
+        releases += (uint32_t)__builtin_popcount(r);
+    }
+#ifdef HAVE_TSC
+    uint64_t c1 = __rdtsc();
+#endif
+    uint64_t t1 = now_ns();
+
+    printf("DEBOUNCE_SAMPLES   %d (%d Zählerbits)\n", DEBOUNCE_SAMPLES, DEBOUNCE_BITS);
+    printf("samples            %u x 32 keys\n", n);
+    printf("transitions        %u generated, %u press + %u release detected\n",
+           transitions, presses, releases);
+    printf("time               %.2f ns/sample, %.3f ns/key\n",
+           (double)(t1 - t0) / n, (double)(t1 - t0) / n / 32.0);
+#ifdef HAVE_TSC
+    printf("tsc                %.1f ticks/sample\n", (double)(c1 - c0) / n);
+#endif
+    printf("(state %08x)\n", sink);
+    free(seq);
+    return 0;
+}
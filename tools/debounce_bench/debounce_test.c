@@ -0,0 +1,142 @@
+/*
+ * debounce_test.c
+ *
+ *  Host-Test für Core/Src/debounce.c (unverändert): feste Prellmuster und
+ *  ein Zufallslauf gegen ein einfaches Modell mit einem Zähler je Taste.
+ *
+ *  Aufruf:  make test   (baut und prüft DEBOUNCE_SAMPLES 1, 10 und 15)
+ *  Rückgabe ungleich 0 bei einem Fehler.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "debounce.h"
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { failures++; printf("FEHLER %s:%d: ", __FILE__, __LINE__); \
+                                              printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static uint32_t rng = 12345;
+static uint32_t rnd(void) { rng = rng * 1664525u + 1013904223u; return rng >> 8; }
+
+/* Eine Abtastung plus Prüfung der Masken gegen den stabilen Zustand */
+static uint32_t sample(debounce_t *d, uint32_t raw, uint32_t *press, uint32_t *release) {
+    uint32_t before = d->stable;
+    uint32_t stable = debounce_sample(d, raw, press, release);
+
+    CHECK(stable == d->stable, "Rückgabe 0x%08x, stable 0x%08x", stable, d->stable);
+    CHECK((*press & *release) == 0, "Taste gleichzeitig gedrückt und losgelassen: 0x%08x", *press & *release);
+    CHECK((*press & ~stable) == 0, "press 0x%08x nicht in stable 0x%08x", *press, stable);
+    CHECK((*release & stable) == 0, "release 0x%08x noch in stable 0x%08x", *release, stable);
+    CHECK((before ^ stable) == (*press | *release), "Wechsel 0x%08x ohne passende Flanke", before ^ stable);
+    return stable;
+}
+
+/* Prellen kürzer als DEBOUNCE_SAMPLES darf keine Flanke erzeugen */
+static void test_short_bounce(void) {
+    for (uint32_t len = 1; len < DEBOUNCE_SAMPLES; len++) {
+        debounce_t d;
+        uint32_t p, r;
+        debounce_init(&d);
+
+        /* Ruhe -> kurz gedrückt -> Ruhe, mehrmals */
+        for (int rep = 0; rep < 4; rep++) {
+            for (uint32_t i = 0; i < len; i++) {
+                sample(&d, 0xFFFFFFFFu, &p, &r);
+                CHECK(p == 0 && r == 0, "Prellen %u beim Drücken: press 0x%08x", len, p);
+            }
+            sample(&d, 0, &p, &r);
+            CHECK(p == 0 && r == 0, "Prellen %u: Flanke nach Rückprall", len);
+        }
+        CHECK(d.stable == 0, "Prellen %u: stable 0x%08x", len, d.stable);
+
+        /* Gedrückt -> kurz offen -> gedrückt */
+        for (uint32_t i = 0; i < DEBOUNCE_SAMPLES; i++) sample(&d, 0xFFFFFFFFu, &p, &r);
+        CHECK(d.stable == 0xFFFFFFFFu, "Prellen %u: Taste nicht gedrückt", len);
+        for (uint32_t i = 0; i < len; i++) {
+            sample(&d, 0, &p, &r);
+            CHECK(p == 0 && r == 0, "Prellen %u beim Loslassen: release 0x%08x", len, r);
+        }
+        sample(&d, 0xFFFFFFFFu, &p, &r);
+        CHECK(p == 0 && r == 0 && d.stable == 0xFFFFFFFFu, "Prellen %u: Flanke nach Rückprall", len);
+    }
+}
+
+/* Jeder stabile Wechsel: genau eine Flanke nach DEBOUNCE_SAMPLES Abtastungen */
+static void test_transitions(void) {
+    debounce_t d;
+    uint32_t p, r;
+    debounce_init(&d);
+
+    for (uint32_t bit = 0; bit < 32; bit++) {
+        uint32_t mask = 1u << bit;
+        uint32_t presses = 0, releases = 0;
+
+        for (uint32_t i = 1; i <= 3 * DEBOUNCE_SAMPLES; i++) {
+            sample(&d, mask, &p, &r);
+            CHECK(r == 0, "Taste %u: release beim Drücken", bit);
+            if (p) {
+                CHECK(p == mask, "Taste %u: press 0x%08x", bit, p);
+                CHECK(i == DEBOUNCE_SAMPLES, "Taste %u: press nach %u statt %u Abtastungen", bit, i, DEBOUNCE_SAMPLES);
+                presses++;
+            }
+        }
+        for (uint32_t i = 1; i <= 3 * DEBOUNCE_SAMPLES; i++) {
+            sample(&d, 0, &p, &r);
+            CHECK(p == 0, "Taste %u: press beim Loslassen", bit);
+            if (r) {
+                CHECK(r == mask, "Taste %u: release 0x%08x", bit, r);
+                CHECK(i == DEBOUNCE_SAMPLES, "Taste %u: release nach %u statt %u Abtastungen", bit, i, DEBOUNCE_SAMPLES);
+                releases++;
+            }
+        }
+        CHECK(presses == 1 && releases == 1, "Taste %u: %u presses, %u releases", bit, presses, releases);
+    }
+}
+
+/* Zufallslauf: alle 32 Tasten unabhängig, Vergleich mit einem Zähler je Taste */
+static void test_model(uint32_t n) {
+    debounce_t d;
+    uint32_t model_stable = 0;
+    uint8_t  model_cnt[32] = {0};
+    uint32_t raw = 0;
+
+    debounce_init(&d);
+    for (uint32_t s = 0; s < n; s++) {
+        /* Einzelne Bits kippen: mal Prellen, mal stabile Wechsel */
+        if ((rnd() & 3) == 0) raw ^= 1u << (rnd() % 32);
+        if ((rnd() & 15) == 0) raw ^= rnd();
+
+        uint32_t p, r, expect_p = 0, expect_r = 0;
+        for (int i = 0; i < 32; i++) {
+            uint32_t bit = 1u << i;
+            if ((raw ^ model_stable) & bit) {
+                if (++model_cnt[i] == DEBOUNCE_SAMPLES) {
+                    model_cnt[i] = 0;
+                    model_stable ^= bit;
+                    if (model_stable & bit) expect_p |= bit; else expect_r |= bit;
+                }
+            } else {
+                model_cnt[i] = 0;
+            }
+        }
+
+        sample(&d, raw, &p, &r);
+        if (p != expect_p || r != expect_r || d.stable != model_stable) {
+            CHECK(0, "Abtastung %u: press 0x%08x/0x%08x release 0x%08x/0x%08x stable 0x%08x/0x%08x",
+                  s, p, expect_p, r, expect_r, d.stable, model_stable);
+            return;
+        }
+    }
+}
+
+int main(void) {
+    test_short_bounce();
+    test_transitions();
+    test_model(1000000u);
+
+    printf("DEBOUNCE_SAMPLES   %d\n", DEBOUNCE_SAMPLES);
+    printf("result             %s (%d failures)\n", failures ? "FAIL" : "ok", failures);
+    return failures ? 1 : 0;
+}
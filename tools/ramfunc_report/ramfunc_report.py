@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+"""Zeigt, welche Funktionen aus dem SRAM laufen (.RamFunc, Core/Inc/ramfunc.h).
+
+    ramfunc_report.py Debug/OPENXHC_HB04_2025.elf [--nm arm-none-eabi-nm]
+
+Liest die Symbole mit nm: alle Funktionen zwischen _sramfunc und _eramfunc
+mit Größe, dazu die Summe. Der Code belegt dieselbe Größe zusätzlich im
+Flash (Ladeabbild von .data).
+"""
+
+import argparse
+import subprocess
+import sys
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument('elf')
+    ap.add_argument('--nm', default='arm-none-eabi-nm')
+    args = ap.parse_args()
+
+    out = subprocess.run([args.nm, '-S', '--defined-only', args.elf],
+                         check=True, capture_output=True, text=True).stdout
+
+    syms = {}
+    funcs = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 3:                       # ohne Größe (Linker-Symbole)
+            syms[parts[2]] = int(parts[0], 16)
+        elif len(parts) == 4 and parts[2] in 'tT':
+            funcs.append((int(parts[0], 16), int(parts[1], 16), parts[3]))
+
+    if '_sramfunc' not in syms or '_eramfunc' not in syms:
+        sys.exit('_sramfunc/_eramfunc fehlen: Linkerskript ohne RAMFUNC-Bereich?')
+    start, end = syms['_sramfunc'], syms['_eramfunc']
+
+    total = 0
+    print('%-10s %6s  %s' % ('Adresse', 'Bytes', 'Funktion'))
+    for addr, size, name in sorted(funcs):
+        if start <= (addr & ~1) < end:
+            print('0x%08x %6u  %s' % (addr, size, name))
+            total += size
+    print('%-10s %6u  (Bereich %u Byte inkl. Ausrichtung)' % ('Summe', total, end - start))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,385 @@
+/*
+ * settings_sim.c
+ *
+ *  Host-Test für Core/Src/settings.c gegen einen emulierten Flash:
+ *  zwei 1-KB-Seiten, Halbwort-Programmierung nur auf gelöschte Zellen
+ *  (wie PGERR beim F103), Seitenlöschung auf 0xFF. Ein Stromausfall bricht
+ *  nach einer wählbaren Zahl von Flash-Operationen ab und hinterlässt die
+ *  laufende Operation halb ausgeführt.
+ *
+ *  Geprüft wird:
+ *   - leerer Flash -> Vorgabewerte, erster Flush legt die Seite an
+ *   - Werte überstehen einen Neustart, Schreiben erst nach der Ruhezeit
+ *   - viele Änderungen: Kompaktierung, beide Seiten gleich oft gelöscht
+ *   - Stromausfall bei jeder Operation einer Flush-Folge mit Kompaktierung:
+ *     nach dem Neustart je Schlüssel alter oder neuer Wert, Speicher bleibt nutzbar
+ *   - umgekippte Bits in einem Datensatz -> CRC-Fehler, älterer Wert gilt
+ *   - Bus aktiv: settings_poll() greift nie auf den Flash zu, Änderungen
+ *     bleiben vorgemerkt; Bus ruhig: Reserveseite vorab gelöscht,
+ *     Kompaktierung danach ohne Löschen
+ *
+ *  Aufruf:  settings_sim [änderungen]
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "settings.h"
+#include "stm32f1xx_hal.h"
+
+/* ----------------------------- HAL-Simulation ----------------------------- */
+
+DWT_Type       sim_dwt;
+CoreDebug_Type sim_coredebug;
+uint32_t       SystemCoreClock = 72000000U;
+
+static uint32_t sim_tick = 0;
+uint32_t HAL_GetTick(void) { return sim_tick; }
+
+#define FLASH_SIZE  (SETTINGS_PAGES * SETTINGS_PAGE_SIZE)
+
+static uint8_t  flash[FLASH_SIZE];
+static uint32_t erases[SETTINGS_PAGES];
+static uint32_t programs;
+static uint8_t  locked = 1;
+static long     cut_after = -1;   // Operationen bis zum Stromausfall, -1 = nie
+static jmp_buf  power_cut;
+static uint32_t rng = 12345;
+
+static uint32_t rnd(void) { rng = rng * 1664525u + 1013904223u; return rng >> 8; }
+
+const uint8_t *sim_flash_ptr(uint32_t addr) {
+    if (addr < SETTINGS_FLASH_BASE || addr + 4 > SETTINGS_FLASH_BASE + FLASH_SIZE) {
+        fprintf(stderr, "Lesezugriff außerhalb: 0x%08x\n", addr);
+        exit(1);
+    }
+    return &flash[addr - SETTINGS_FLASH_BASE];
+}
+
+/* Zählt die Operation; beim Stromausfall true */
+static int cut_now(void) {
+    if (cut_after < 0) return 0;
+    return cut_after-- == 0;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void) { locked = 0; return HAL_OK; }
+HAL_StatusTypeDef HAL_FLASH_Lock(void) { locked = 1; return HAL_OK; }
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data) {
+    if (locked || TypeProgram != FLASH_TYPEPROGRAM_HALFWORD || (Address & 1)) return HAL_ERROR;
+    if (Address < SETTINGS_FLASH_BASE || Address + 2 > SETTINGS_FLASH_BASE + FLASH_SIZE) return HAL_ERROR;
+
+    uint8_t *p = &flash[Address - SETTINGS_FLASH_BASE];
+    uint16_t cur = (uint16_t)(p[0] | p[1] << 8);
+    uint16_t v = (uint16_t)Data;
+    if (cur != 0xFFFF && v != 0) return HAL_ERROR;   // PGERR: Zelle nicht gelöscht
+
+    if (cut_now()) {
+        v |= (uint16_t)rnd();   // abgebrochen: nur ein Teil der Bits programmiert
+        p[0] &= (uint8_t)v; p[1] &= (uint8_t)(v >> 8);
+        longjmp(power_cut, 1);
+    }
+    p[0] &= (uint8_t)v; p[1] &= (uint8_t)(v >> 8);
+    programs++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError) {
+    *PageError = 0xFFFFFFFFU;
+    if (locked || pEraseInit->TypeErase != FLASH_TYPEERASE_PAGES) return HAL_ERROR;
+
+    for (uint32_t i = 0; i < pEraseInit->NbPages; i++) {
+        uint32_t addr = pEraseInit->PageAddress + i * SETTINGS_PAGE_SIZE;
+        if (addr < SETTINGS_FLASH_BASE || addr >= SETTINGS_FLASH_BASE + FLASH_SIZE) {
+            *PageError = addr;
+            return HAL_ERROR;
+        }
+        uint32_t page = (addr - SETTINGS_FLASH_BASE) / SETTINGS_PAGE_SIZE;
+        uint8_t *p = &flash[page * SETTINGS_PAGE_SIZE];
+
+        if (cut_now()) {
+            /* abgebrochen: ein zufälliger Teil der Seite ist schon gelöscht */
+            for (uint32_t b = 0; b < SETTINGS_PAGE_SIZE; b++) if (rnd() & 1) p[b] = 0xFF;
+            longjmp(power_cut, 1);
+        }
+        memset(p, 0xFF, SETTINGS_PAGE_SIZE);
+        erases[page]++;
+    }
+    return HAL_OK;
+}
+
+/* --------------------------------- Tests ---------------------------------- */
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { failures++; printf("FEHLER %s:%d: ", __FILE__, __LINE__); \
+                                              printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static void flash_blank(void) {
+    memset(flash, 0xFF, sizeof(flash));
+    memset(erases, 0, sizeof(erases));
+    programs = 0;
+}
+
+/* Neustart: RAM-Zustand verwerfen, Log neu lesen */
+static void reboot(void) {
+    cut_after = -1;
+    locked = 1;
+    settings_init();
+}
+
+static void check_values(const uint32_t *expect, const char *what) {
+    for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) {
+        CHECK(settings_get((settings_key_t)k) == expect[k], "%s: Schlüssel %u = %u, erwartet %u",
+              what, k, settings_get((settings_key_t)k), expect[k]);
+    }
+}
+
+static void test_blank(void) {
+    settings_stats_t s;
+
+    flash_blank();
+    reboot();
+    settings_get_stats(&s);
+    CHECK(s.active_page == 0xFFFFFFFFU, "leerer Flash: aktive Seite %u", s.active_page);
+    CHECK(s.loaded == 0 && s.crc_errors == 0, "leerer Flash: %u geladen, %u Fehler", s.loaded, s.crc_errors);
+
+    /* Vorgabewert setzen schreibt nichts */
+    settings_set(SETTINGS_KEY_ENC_REVERSE, settings_get(SETTINGS_KEY_ENC_REVERSE));
+    settings_flush();
+    CHECK(programs == 0 && erases[0] + erases[1] == 0, "Vorgabewert hat geschrieben");
+
+    settings_set(SETTINGS_KEY_ENC_REVERSE, 1);
+    settings_flush();
+    settings_get_stats(&s);
+    CHECK(s.active_page == 0 && s.seq == 1, "erster Flush: Seite %u, seq %u", s.active_page, s.seq);
+}
+
+static void test_persist(void) {
+    uint32_t expect[SETTINGS_KEY_COUNT];
+
+    flash_blank();
+    reboot();
+    for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) {
+        expect[k] = 0x1000 + k;
+        settings_set((settings_key_t)k, expect[k]);
+    }
+
+    /* Ruhezeit: vorher schreibt settings_poll() nichts */
+    sim_tick = 10000;
+    settings_set(SETTINGS_KEY_ENC_ACCEL, expect[SETTINGS_KEY_ENC_ACCEL]);
+    sim_tick += SETTINGS_FLUSH_DELAY_MS - 1;
+    settings_poll(1);
+    CHECK(programs == 0, "settings_poll() vor Ablauf der Ruhezeit hat geschrieben");
+    sim_tick += 1;
+    settings_poll(1);
+    CHECK(programs != 0, "settings_poll() nach der Ruhezeit hat nicht geschrieben");
+
+    reboot();
+    check_values(expect, "nach Neustart");
+}
+
+static void test_wear(uint32_t changes) {
+    uint32_t expect[SETTINGS_KEY_COUNT];
+    settings_stats_t s;
+
+    flash_blank();
+    reboot();
+    for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) expect[k] = settings_get((settings_key_t)k);
+
+    for (uint32_t i = 0; i < changes; i++) {
+        uint32_t k = rnd() % SETTINGS_KEY_COUNT;
+        expect[k] = rnd() % 4;
+        settings_set((settings_key_t)k, expect[k]);
+        if (rnd() % 3 == 0) {
+            settings_flush();
+            if (rnd() % 50 == 0) {
+                reboot();
+                check_values(expect, "Dauerlauf");
+            }
+        }
+    }
+    settings_flush();
+    settings_get_stats(&s);
+    CHECK(s.flash_errors == 0, "Dauerlauf: %u Flash-Fehler", s.flash_errors);
+    reboot();
+    check_values(expect, "Dauerlauf Ende");
+
+    uint32_t diff = erases[0] > erases[1] ? erases[0] - erases[1] : erases[1] - erases[0];
+    CHECK(diff <= 1, "Verschleiß ungleich: Seite 0 %u, Seite 1 %u Löschungen", erases[0], erases[1]);
+    printf("wear               %u changes, %u halfwords programmed, erases %u/%u\n",
+           changes, programs, erases[0], erases[1]);
+}
+
+/* Stromausfall bei jeder Operation einer Folge von Flushes inkl. Kompaktierung */
+static void test_power_cut(void) {
+    static uint8_t base_flash[FLASH_SIZE];
+    uint32_t before[SETTINGS_KEY_COUNT], after[SETTINGS_KEY_COUNT];
+    uint32_t cuts = 0, torn = 0;
+
+    /* Ausgangslage: aktive Seite fast voll, die nächsten Flushes kompaktieren */
+    flash_blank();
+    reboot();
+    settings_stats_t s;
+    do {
+        settings_set(SETTINGS_KEY_ENC_REVERSE, rnd() % 2 + 2);
+        settings_flush();
+        settings_get_stats(&s);
+    } while (s.free_slots > 2);
+    reboot();
+    memcpy(base_flash, flash, sizeof(flash));
+    for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) before[k] = settings_get((settings_key_t)k);
+    for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) after[k] = before[k] + 7 + k;
+
+    for (long cut = 0;; cut++) {
+        memcpy(flash, base_flash, sizeof(flash));
+        reboot();
+
+        int interrupted = 0;
+        if (setjmp(power_cut) == 0) {
+            cut_after = cut;
+            /* drei Flushes: zwei Datensätze anhängen, dann Kompaktierung */
+            for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) {
+                settings_set((settings_key_t)k, after[k]);
+                settings_flush();
+            }
+            cut_after = -1;
+        } else {
+            interrupted = 1;
+        }
+
+        reboot();
+        for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) {
+            uint32_t v = settings_get((settings_key_t)k);
+            CHECK(v == before[k] || v == after[k], "Ausfall nach %ld Operationen: Schlüssel %u = %u",
+                  cut, k, v);
+        }
+        settings_get_stats(&s);
+        torn += s.crc_errors;
+
+        /* Speicher bleibt nutzbar */
+        for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) settings_set((settings_key_t)k, after[k] + 1);
+        settings_flush();
+        reboot();
+        for (uint32_t k = 0; k < SETTINGS_KEY_COUNT; k++) {
+            CHECK(settings_get((settings_key_t)k) == after[k] + 1,
+                  "nach Ausfall bei %ld: Schlüssel %u nicht schreibbar", cut, k);
+        }
+
+        if (!interrupted) break;   // Folge lief ohne Ausfall durch: alle Punkte geprüft
+        cuts++;
+    }
+    printf("power cut          %u cut points, %u torn records skipped\n", cuts, torn);
+}
+
+static void test_corrupt(void) {
+    settings_stats_t s;
+
+    flash_blank();
+    reboot();
+    settings_set(SETTINGS_KEY_ENC_ACCEL, 5);
+    settings_flush();
+    settings_set(SETTINGS_KEY_ENC_ACCEL, 6);
+    settings_flush();
+
+    /* Wert des zweiten Datensatzes: Bit löschen (Kopf 8 + Datensatz 8 + Wert-Offset 4) */
+    flash[8 + 8 + 4] &= (uint8_t)~0x02;
+    reboot();
+    settings_get_stats(&s);
+    CHECK(s.crc_errors == 1, "Bitfehler: %u CRC-Fehler", s.crc_errors);
+    CHECK(settings_get(SETTINGS_KEY_ENC_ACCEL) == 5, "Bitfehler: Wert %u statt 5",
+          settings_get(SETTINGS_KEY_ENC_ACCEL));
+}
+
+/* Aktive Seite bis zum letzten Datensatz füllen */
+static void fill_active(void) {
+    settings_stats_t s;
+    uint32_t v = 2;
+
+    settings_get_stats(&s);
+    while (s.free_slots > 0) {
+        settings_set(SETTINGS_KEY_ENC_REVERSE, v ^= 1);
+        settings_flush();
+        settings_get_stats(&s);
+    }
+}
+
+/* Ausgangslage: Seite 1 aktiv und voll, Seite 0 (Reserve) beschrieben */
+static void setup_full_used_spare(void) {
+    flash_blank();
+    reboot();
+    fill_active();
+    settings_set(SETTINGS_KEY_ENC_REVERSE, 7);
+    settings_flush();        // Kompaktierung auf die leere Seite 1
+    fill_active();
+    reboot();
+}
+
+static void test_bus_busy(void) {
+    settings_stats_t s;
+    uint32_t e, p;
+
+    /* Bus aktiv: kein Flash-Zugriff, auch nicht nach langer Zeit */
+    setup_full_used_spare();
+    e = erases[0] + erases[1];
+    p = programs;
+    sim_tick += 100000;
+    settings_set(SETTINGS_KEY_ENC_ACCEL, 9);
+    for (uint32_t i = 0; i < 100; i++) {
+        sim_tick += 60000;
+        settings_poll(0);
+    }
+    settings_get_stats(&s);
+    CHECK(erases[0] + erases[1] == e && programs == p && s.compactions == 0,
+          "Bus aktiv: %u Löschungen, %u Halbwörter, %u Kompaktierungen",
+          erases[0] + erases[1] - e, programs - p, s.compactions);
+    CHECK(settings_get(SETTINGS_KEY_ENC_ACCEL) == 9, "Bus aktiv: RAM-Wert %u statt 9",
+          settings_get(SETTINGS_KEY_ENC_ACCEL));
+
+    /* Bus ruhig: erst die Reserve löschen, im nächsten Aufruf ohne Löschen kompaktieren */
+    settings_poll(1);
+    CHECK(erases[0] + erases[1] == e + 1, "Bus ruhig: Reserveseite nicht vorab gelöscht");
+    settings_get_stats(&s);
+    CHECK(s.compactions == 0, "Bus ruhig: Löschen und Kompaktierung in einem Aufruf");
+    settings_poll(1);
+    settings_get_stats(&s);
+    CHECK(s.compactions == 1 && erases[0] + erases[1] == e + 1,
+          "Bus ruhig: %u Kompaktierungen, %u Löschungen", s.compactions, erases[0] + erases[1] - e);
+    reboot();
+    CHECK(settings_get(SETTINGS_KEY_ENC_ACCEL) == 9, "Bus ruhig: Wert %u statt 9",
+          settings_get(SETTINGS_KEY_ENC_ACCEL));
+
+    /* Ein einzelner Datensatz wartet ebenso auf Ruhe */
+    flash_blank();
+    reboot();
+    p = programs;
+    settings_set(SETTINGS_KEY_ENC_ACCEL, 11);
+    sim_tick += SETTINGS_FLUSH_DELAY_MS;
+    settings_poll(0);
+    CHECK(programs == p, "Bus aktiv: Datensatz geschrieben");
+    settings_poll(1);
+    CHECK(programs != p, "Bus ruhig: Datensatz nicht geschrieben");
+    reboot();
+    CHECK(settings_get(SETTINGS_KEY_ENC_ACCEL) == 11, "Datensatz: Wert %u statt 11",
+          settings_get(SETTINGS_KEY_ENC_ACCEL));
+    printf("bus busy           no flash access, written once idle\n");
+}
+
+int main(int argc, char **argv) {
+    uint32_t changes = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 20000;
+
+    test_blank();
+    test_persist();
+    test_wear(changes);
+    test_power_cut();
+    test_corrupt();
+    test_bus_busy();
+
+    settings_stats_t s;
+    settings_get_stats(&s);
+    printf("slots/page         %u\n", s.used_slots + s.free_slots);
+    printf("result             %s (%d failures)\n", failures ? "FAIL" : "ok", failures);
+    return failures ? 1 : 0;
+}
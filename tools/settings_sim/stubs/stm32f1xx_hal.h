@@ -0,0 +1,55 @@
+/*
+ * stm32f1xx_hal.h (Host-Stub)
+ *
+ *  Minimaler Ersatz für HAL/CMSIS, damit Core/Src/settings.c unverändert
+ *  gegen einen emulierten Flash (settings_sim.c) übersetzt werden kann.
+ */
+
+#ifndef STUB_STM32F1XX_HAL_H_
+#define STUB_STM32F1XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+
+/* Zeitbasis des Tests */
+uint32_t HAL_GetTick(void);
+extern uint32_t SystemCoreClock;
+
+typedef struct { volatile uint32_t CTRL; volatile uint32_t CYCCNT; } DWT_Type;
+typedef struct { volatile uint32_t DEMCR; } CoreDebug_Type;
+extern DWT_Type       sim_dwt;
+extern CoreDebug_Type sim_coredebug;
+#define DWT       (&sim_dwt)
+#define CoreDebug (&sim_coredebug)
+#define DWT_CTRL_CYCCNTENA_Msk        (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk    (1UL << 24)
+
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+
+/* Flash-HAL wie stm32f1xx_hal_flash(_ex).h, Seiten à 1 KB */
+#define FLASH_TYPEPROGRAM_HALFWORD  0x01U
+#define FLASH_TYPEERASE_PAGES       0x00U
+#define FLASH_PAGE_SIZE             0x400U
+
+typedef struct {
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t PageAddress;
+    uint32_t NbPages;
+} FLASH_EraseInitTypeDef;
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError);
+
+/* Lesezugriff von settings.c auf das emulierte Array */
+const uint8_t *sim_flash_ptr(uint32_t addr);
+#define SETTINGS_FLASH_PTR(addr)  sim_flash_ptr(addr)
+
+#endif /* STUB_STM32F1XX_HAL_H_ */
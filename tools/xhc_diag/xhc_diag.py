@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""Liest die Diagnoseseiten des Pendants (Feature-Report 0x07) über hidraw.
+
+    xhc_diag.py /dev/hidrawN [seite ...]
+    xhc_diag.py /dev/hidrawN input
+    xhc_diag.py /dev/hidrawN set <einstellung> <wert>
+    xhc_diag.py /dev/hidrawN prof
+
+Ohne Seitenangabe werden alle bekannten Seiten ausgegeben. "input" liest
+den aktuellen Input-Report 0x04 per GET_REPORT (Linux >= 5.11). "set"
+ändert eine Einstellung (Namen siehe SETTINGS); das Pendant schreibt sie
+nach einer Ruhezeit von 2 s in den Flash. "prof" holt die gesammelten
+Profiling-Ereignisse ab (Seite PROF_EVENTS, leert den Ring) und gibt sie
+als Zeilen "start_cycles zone cycles" aus.
+"""
+
+import fcntl
+import os
+import struct
+import sys
+
+REPORT_ID = 0x07
+REPORT_LEN = 64
+CMD_SETTING = 0x80
+PAGE_PROF_EVENTS = 19
+CPU_MHZ = 72
+
+# Schlüssel wie settings_key_t
+SETTINGS = ['enc_reverse', 'enc_accel', 'display_flip']
+
+# Feldnamen je Seite, Reihenfolge wie in den C-Strukturen
+PAGES = {
+    0: ('rx', ['frames', 'frames_per_sec', 'duplicates', 'resyncs', 'incomplete',
+               'orphan_chunks', 'overflow', 'gap_last_us', 'gap_max_us',
+               'ring_dropped', 'ring_highwater']),
+    1: ('in', ['in_sent', 'in_completed', 'in_per_sec', 'busy_frames',
+               'wait_last_us', 'wait_avg_us', 'wait_max_us',
+               'poll_last_us', 'poll_max_us',
+               'carry_reports', 'carry_last', 'carry_max', 'prearmed',
+               'get_reports', 'boot_report_ms']),
+    2: ('defer', ['rx.posts', 'rx.runs', 'rx.lat_last_us', 'rx.lat_max_us',
+                  'rx.run_last_us', 'rx.run_max_us']),
+    3: ('input', ['kp.samples', 'kp.presses', 'kp.releases',
+                  'kp.poll_cycles_last', 'kp.poll_cycles_max',
+                  'sel.changes', 'sel.edges', 'sel.glitches', 'sel.poll_changes',
+                  'sel.latency_last_us', 'sel.latency_max_us']),
+    4: ('encoder', ['counts', 'detents', 'steps', 'velocity', 'velocity_max',
+                    'multiplier', 'mode_holds', 'steps_dropped']),
+}
+
+# Latenz-Histogramme (trace.c): Klasse i = [2^i, 2^(i+1)) us, letzte = Rest
+HIST_LABELS = ['<2us'] + ['%dus' % (1 << i) for i in range(1, 14)] + ['>=16ms']
+for _n, _stage in enumerate(['edge_queue', 'queue_send', 'send_done', 'edge_done']):
+    PAGES[5 + _n] = ('trace.' + _stage, HIST_LABELS)
+
+PAGES[9] = ('sched', ['idle_permille', 'idle_min_permille', 'wakeups'] +
+            ['%s.%s' % (t, f) for t in ('display', 'stats', 'telemetry')
+             for f in ('runs', 'run_last_us', 'run_max_us', 'overruns')])
+PAGES[10] = ('ep0', ['chunks', 'slow_reports', 'turnaround_last_us', 'turnaround_max_us',
+                     'interval_last_us', 'interval_min_us', 'aborted'])
+PAGES[11] = ('power', ['suspends', 'resumes', 'remote_wakeups', 'wakes_ignored',
+                       'stop_entries', 'resume_us_last', 'resume_us_max', 'clock_failures'])
+PAGES[12] = ('settings', ['seq', 'active_page', 'used_slots', 'free_slots', 'loaded',
+                          'crc_errors', 'scan_us', 'writes', 'compactions', 'flash_errors',
+                          'write_us_max', 'erase_us_max'] + SETTINGS)
+PAGES[13] = ('memory', ['ram_static', 'ramfunc', 'heap_used', 'heap_peak', 'heap_fails',
+                        'stack_reserved', 'stack_peak', 'stack_free'] +
+             ['isr_entry_depth.' + l for l in ('usb', 'dma_spi', 'input', 'systick', 'defer')])
+
+# Profiling-Zonen wie prof_zone_t; die Ereignisseite steht nicht in PAGES,
+# weil jedes Lesen den Ring leert
+PROF_ZONES = ['main_loop', 'usb_irq', 'process_rx', 'write_string', 'fill_rect']
+for _n, _zone in enumerate(PROF_ZONES):
+    PAGES[14 + _n] = ('prof.' + _zone, ['count', 'min_cycles', 'max_cycles', 'last_cycles',
+                                        'total_lo', 'total_hi'])
+_SRCS = ('usb', 'dma_spi', 'input', 'systick')
+PAGES[20] = ('idle', ['dma_sleeps', 'dma_sleep_ms'] +
+             ['wake_cycles_last.' + s for s in _SRCS] + ['wake_cycles_max.' + s for s in _SRCS] +
+             ['tick_lat_run_last', 'tick_lat_run_max', 'tick_lat_sleep_last', 'tick_lat_sleep_max'])
+for _n, _src in enumerate(['keypad', 'selector', 'encoder']):
+    PAGES[21 + _n] = ('trace.edge_queue.' + _src, HIST_LABELS)
+
+
+def _ioc(nr, size):
+    return (3 << 30) | (size << 16) | (ord('H') << 8) | nr
+
+
+def read_page(fd, page):
+    buf = bytearray(REPORT_LEN)
+    buf[0] = REPORT_ID
+    buf[1] = page
+    fcntl.ioctl(fd, _ioc(0x06, REPORT_LEN), bytes(buf))          # HIDIOCSFEATURE
+    buf = bytearray(REPORT_LEN)
+    buf[0] = REPORT_ID
+    fcntl.ioctl(fd, _ioc(0x07, REPORT_LEN), buf, True)           # HIDIOCGFEATURE
+    count = buf[2]
+    return buf[1], struct.unpack_from('<%dI' % count, buf, 4)
+
+
+def write_setting(fd, key, value):
+    buf = bytearray(REPORT_LEN)
+    buf[0] = REPORT_ID
+    buf[1] = CMD_SETTING
+    buf[2] = key
+    struct.pack_into('<I', buf, 4, value)
+    fcntl.ioctl(fd, _ioc(0x06, REPORT_LEN), bytes(buf))          # HIDIOCSFEATURE
+
+
+def read_prof_events(fd):
+    """Liest die Ereignisseite, bis der Ring leer ist."""
+    dropped = 0
+    while True:
+        _, values = read_page(fd, PAGE_PROF_EVENTS)
+        if len(values) < 2:
+            break
+        dropped += values[0]
+        for i in range(2, len(values) - 1, 2):
+            start, packed = values[i], values[i + 1]
+            zone = packed >> 24
+            name = PROF_ZONES[zone] if zone < len(PROF_ZONES) else 'zone%d' % zone
+            cycles = packed & 0xFFFFFF
+            print('%10u %-12s %8u  (%.1f us)' % (start, name, cycles, cycles / CPU_MHZ))
+        if values[1] == 0 or len(values) == 2:
+            break
+    print('# verworfen seit dem letzten Abholen: %u' % dropped)
+
+
+def read_input(fd):
+    buf = bytearray(6)
+    buf[0] = 0x04
+    fcntl.ioctl(fd, _ioc(0x0A, len(buf)), buf, True)            # HIDIOCGINPUT
+    _, btn1, btn2, mode, wheel, xor_day = struct.unpack('<BBBBbB', buf)
+    print('[input]')
+    print('  btn_1 0x%02x  btn_2 0x%02x  wheel_mode 0x%02x  wheel %d  xor_day 0x%02x'
+          % (btn1, btn2, mode, wheel, xor_day))
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    if sys.argv[2:] == ['input']:
+        fd = os.open(sys.argv[1], os.O_RDWR)
+        try:
+            read_input(fd)
+        finally:
+            os.close(fd)
+        return
+    if sys.argv[2:3] == ['set']:
+        if len(sys.argv) != 5 or sys.argv[3] not in SETTINGS:
+            sys.exit('Einstellungen: ' + ', '.join(SETTINGS))
+        fd = os.open(sys.argv[1], os.O_RDWR)
+        try:
+            write_setting(fd, SETTINGS.index(sys.argv[3]), int(sys.argv[4], 0))
+        finally:
+            os.close(fd)
+        return
+    if sys.argv[2:] == ['prof']:
+        fd = os.open(sys.argv[1], os.O_RDWR)
+        try:
+            read_prof_events(fd)
+        finally:
+            os.close(fd)
+        return
+    pages = [int(p) for p in sys.argv[2:]] or sorted(PAGES)
+    fd = os.open(sys.argv[1], os.O_RDWR)
+    try:
+        for page in pages:
+            got, values = read_page(fd, page)
+            name, fields = PAGES.get(got, ('page%d' % got, []))
+            print('[%s]' % name)
+            for i, v in enumerate(values):
+                label = fields[i] if i < len(fields) else 'value%d' % i
+                print('  %-16s %u' % (label, v))
+    finally:
+        os.close(fd)
+
+
+if __name__ == '__main__':
+    main()
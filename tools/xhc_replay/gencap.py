@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""Synthetischer xhc-hb04 Mitschnitt für xhc_replay.
+
+Erzeugt whb04_out_data Frames (37 Byte, Magic 0xFDFE), zerlegt wie
+LinuxCNC in 6 SET_REPORT 0x06 Chunks zu je 7 Byte. Die Achsen fahren
+eine langsame Rampe, damit die Anzeige wie im Betrieb nachzieht.
+
+    gencap.py [-s sekunden] [-p frame_ms] [-g chunk_us] > demo.cap
+"""
+
+import argparse
+import struct
+
+
+def encode_pos(value):
+    neg = value < 0
+    value = abs(value)
+    p_int = int(value) & 0xFFFF
+    p_frac = int(round((value - int(value)) * 10000)) & 0x7FFF
+    if neg:
+        p_frac |= 0x8000
+    return p_int, p_frac
+
+
+def build_frame(t, day):
+    pos = []
+    for axis in range(6):
+        v = (t * (axis % 3 + 1) * 1.7) - 20.0
+        pos.extend(encode_pos(v))
+    return struct.pack('<HB12HHHHHBB', 0xFDFE, day, *pos,
+                       100, 100, 1200, 12000, 1, 0)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument('-s', '--seconds', type=float, default=10.0)
+    ap.add_argument('-p', '--period-ms', type=float, default=10.0,
+                    help='Abstand der Frames (LinuxCNC servo/HAL-Takt)')
+    ap.add_argument('-g', '--gap-us', type=int, default=1000,
+                    help='Abstand der Chunks innerhalb eines Frames')
+    args = ap.parse_args()
+
+    print('# xhc-capture v1 (gencap.py)')
+    t_us = 0
+    day = 0x5A
+    while t_us < args.seconds * 1e6:
+        frame = build_frame(t_us / 1e6, day)
+        frame += bytes(42 - len(frame))
+        for i in range(6):
+            chunk = b'\x06' + frame[i * 7:(i + 1) * 7]
+            print(f'{t_us + i * args.gap_us} {chunk.hex()}')
+        t_us += int(args.period_ms * 1000)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,157 @@
+/*
+ * sim_display.c
+ *
+ *  Simuliertes ST7735 für das Replay-Tool: gleiche API wie
+ *  Drivers/ST7735/st7735.c, zählt aber die SPI-Bytes/Transfers, die der
+ *  echte Treiber erzeugen würde, und zeichnet in einen RGB565-Framebuffer.
+ */
+
+#include "sim_display.h"
+#include "st7735.h"
+#include <stdio.h>
+
+static uint16_t fb[ST7735_HEIGHT][ST7735_WIDTH];
+static sim_display_stats_t stats;
+
+/* CASET + 4 Byte, RASET + 4 Byte, RAMWR: 5 SPI-Transfers, 11 Byte */
+static void count_window(void) {
+    stats.spi_bytes += 11;
+    stats.spi_transfers += 5;
+    stats.windows++;
+}
+
+static void put(int x, int y, uint16_t c) {
+    if (x < 0 || y < 0 || x >= ST7735_WIDTH || y >= ST7735_HEIGHT) return;
+    fb[y][x] = c;
+}
+
+void ST7735_Init(void) {}
+void ST7735_InitStart(void) {}
+uint16_t ST7735_InitStep(void) { return 0; }
+bool ST7735_IsReady(void) { return true; }
+void ST7735_Select(void) {}
+void ST7735_Unselect(void) {}
+void ST7735_InvertColors(bool invert) { (void)invert; stats.spi_bytes += 1; stats.spi_transfers++; }
+void ST7735_SetGamma(GammaDef gamma) { (void)gamma; stats.spi_bytes += 2; stats.spi_transfers += 2; }
+void ST7735_SetFlip(bool flip) { (void)flip; stats.spi_bytes += 2; stats.spi_transfers += 2; }
+void ST7735_Sleep(bool sleep) { (void)sleep; stats.spi_bytes += 2; stats.spi_transfers += 2; }
+void ST7735_SetAddressWindow(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+    (void)x0; (void)y0; (void)x1; (void)y1;
+    count_window();
+}
+
+void ST7735_DrawPixel(uint16_t x, uint16_t y, uint16_t color) {
+    if (x >= ST7735_WIDTH || y >= ST7735_HEIGHT) return;
+    count_window();
+    stats.spi_bytes += 2;
+    stats.spi_transfers++;
+    stats.pixels++;
+    put(x, y, color);
+}
+
+static void write_char(uint16_t x, uint16_t y, char ch, FontDef font,
+                       uint16_t color, uint16_t bgcolor) {
+    count_window();
+    for (uint32_t i = 0; i < font.height; i++) {
+        uint32_t b = font.data[(ch - 32) * font.height + i];
+        for (uint32_t j = 0; j < font.width; j++) {
+            put(x + j, y + i, ((b << j) & 0x8000) ? color : bgcolor);
+        }
+    }
+    /* Der echte Treiber sendet pro Pixel einen blockierenden 2-Byte-Transfer */
+    stats.spi_bytes += (uint32_t)font.width * font.height * 2;
+    stats.spi_transfers += (uint32_t)font.width * font.height;
+    stats.pixels += (uint32_t)font.width * font.height;
+    stats.glyphs++;
+}
+
+void ST7735_WriteString(uint16_t x, uint16_t y, const char *s, FontDef font,
+                        uint16_t color, uint16_t bgcolor) {
+    while (*s) {
+        if (x + font.width >= ST7735_WIDTH) {
+            x = 0;
+            y += font.height;
+            if (y + font.height >= ST7735_HEIGHT) break;
+            if (*s == ' ') { s++; continue; }
+        }
+        write_char(x, y, *s, font, color, bgcolor);
+        x += font.width;
+        s++;
+    }
+}
+
+static void fill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color, int dma) {
+    if (x >= ST7735_WIDTH || y >= ST7735_HEIGHT) return;
+    if ((x + w) > ST7735_WIDTH)  w = ST7735_WIDTH - x;
+    if ((y + h) > ST7735_HEIGHT) h = ST7735_HEIGHT - y;
+
+    count_window();
+    for (uint16_t r = 0; r < h; r++)
+        for (uint16_t c = 0; c < w; c++)
+            put(x + c, y + r, color);
+
+    /* Eine Zeile pro Transfer (DMA bzw. blockierend) */
+    stats.spi_bytes += (uint32_t)w * h * 2;
+    stats.spi_transfers += h;
+    stats.pixels += (uint32_t)w * h;
+    if (dma) stats.dma_starts += h;
+}
+
+void ST7735_FillRectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    fill(x, y, w, h, color, 0);
+}
+
+void ST7735_FillRectangleFast(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    fill(x, y, w, h, color, 1);
+}
+
+void ST7735_FillScreen(uint16_t color) {
+    fill(0, 0, ST7735_WIDTH, ST7735_HEIGHT, color, 1);
+}
+
+void ST7735_DrawImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *data) {
+    if (x >= ST7735_WIDTH || y >= ST7735_HEIGHT) return;
+    uint16_t cw = w, ch = h;
+    if ((x + cw) > ST7735_WIDTH)  cw = ST7735_WIDTH - x;
+    if ((y + ch) > ST7735_HEIGHT) ch = ST7735_HEIGHT - y;
+
+    count_window();
+    for (uint16_t r = 0; r < ch; r++)
+        for (uint16_t c = 0; c < cw; c++)
+            put(x + c, y + r, data[(uint32_t)r * cw + c]);
+
+    stats.spi_bytes += (uint32_t)cw * ch * 2;
+    stats.spi_transfers += ch;
+    stats.dma_starts += ch;
+    stats.pixels += (uint32_t)cw * ch;
+}
+
+void ST7735_MoveRectFrame(uint16_t prev_x, uint16_t new_x, uint16_t y,
+                          uint16_t w, uint16_t h, uint16_t bg, uint16_t fg) {
+    fill(prev_x, y, w, h, bg, 1);
+    fill(new_x, y, w, h, fg, 1);
+}
+
+void sim_display_get_stats(sim_display_stats_t *out) {
+    *out = stats;
+}
+
+int sim_display_write_ppm(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+
+    fprintf(f, "P6\n%d %d\n255\n", ST7735_WIDTH, ST7735_HEIGHT);
+    for (int y = 0; y < ST7735_HEIGHT; y++) {
+        for (int x = 0; x < ST7735_WIDTH; x++) {
+            uint16_t c = fb[y][x];
+            uint8_t rgb[3] = {
+                (uint8_t)(((c >> 11) & 0x1F) << 3),
+                (uint8_t)(((c >> 5) & 0x3F) << 2),
+                (uint8_t)((c & 0x1F) << 3)
+            };
+            fwrite(rgb, 1, 3, f);
+        }
+    }
+    fclose(f);
+    return 0;
+}
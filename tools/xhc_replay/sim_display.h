@@ -0,0 +1,24 @@
+/*
+ * sim_display.h
+ *
+ *  Statistik des simulierten ST7735 (siehe sim_display.c)
+ */
+
+#ifndef SIM_DISPLAY_H_
+#define SIM_DISPLAY_H_
+
+#include <stdint.h>
+
+typedef struct {
+    uint64_t spi_bytes;      // Bytes auf SPI1 (Kommandos + Pixeldaten)
+    uint64_t spi_transfers;  // einzelne HAL_SPI_Transmit / DMA-Starts
+    uint64_t dma_starts;     // davon DMA-Transfers
+    uint64_t windows;        // gesetzte Address Windows
+    uint64_t pixels;
+    uint64_t glyphs;
+} sim_display_stats_t;
+
+void sim_display_get_stats(sim_display_stats_t *out);
+int  sim_display_write_ppm(const char *path);
+
+#endif /* SIM_DISPLAY_H_ */
@@ -0,0 +1,12 @@
+/*
+ * stm32f1xx.h (Host-Stub)
+ *
+ *  Ersetzt den CMSIS-Device-Header beim Host-Build des Replay-Tools.
+ */
+
+#ifndef STUB_STM32F1XX_H_
+#define STUB_STM32F1XX_H_
+
+#include "stm32f1xx_hal.h"
+
+#endif /* STUB_STM32F1XX_H_ */
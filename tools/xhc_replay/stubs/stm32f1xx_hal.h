@@ -0,0 +1,66 @@
+/*
+ * stm32f1xx_hal.h (Host-Stub)
+ *
+ *  Minimaler Ersatz für HAL/CMSIS, damit Decoder und UI der Firmware
+ *  unverändert auf dem Host übersetzt werden können. Zeit (HAL_GetTick,
+ *  DWT->CYCCNT) wird vom Replay-Tool vorgegeben.
+ */
+
+#ifndef STUB_STM32F1XX_HAL_H_
+#define STUB_STM32F1XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+
+typedef struct { uint32_t dummy; } GPIO_TypeDef;
+typedef struct { uint32_t dummy; } SPI_HandleTypeDef;
+
+extern GPIO_TypeDef sim_gpioa, sim_gpiob;
+#define GPIOA (&sim_gpioa)
+#define GPIOB (&sim_gpiob)
+
+#define GPIO_PIN_0   0x0001U
+#define GPIO_PIN_1   0x0002U
+#define GPIO_PIN_2   0x0004U
+#define GPIO_PIN_3   0x0008U
+#define GPIO_PIN_4   0x0010U
+#define GPIO_PIN_5   0x0020U
+#define GPIO_PIN_6   0x0040U
+#define GPIO_PIN_7   0x0080U
+#define GPIO_PIN_8   0x0100U
+#define GPIO_PIN_9   0x0200U
+#define GPIO_PIN_10  0x0400U
+#define GPIO_PIN_11  0x0800U
+#define GPIO_PIN_12  0x1000U
+#define GPIO_PIN_13  0x2000U
+#define GPIO_PIN_14  0x4000U
+#define GPIO_PIN_15  0x8000U
+
+/* Zeitbasis des Replay-Tools */
+uint32_t HAL_GetTick(void);
+void     HAL_Delay(uint32_t ms);
+extern uint32_t SystemCoreClock;
+
+/* Cortex-M Register, soweit von der Anwendung genutzt */
+typedef struct { volatile uint32_t CTRL; volatile uint32_t CYCCNT; } DWT_Type;
+typedef struct { volatile uint32_t DEMCR; } CoreDebug_Type;
+extern DWT_Type       sim_dwt;
+extern CoreDebug_Type sim_coredebug;
+#define DWT       (&sim_dwt)
+#define CoreDebug (&sim_coredebug)
+#define DWT_CTRL_CYCCNTENA_Msk        (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk    (1UL << 24)
+
+/* Single-threaded: Interrupt-Sperren und Barrieren sind leer */
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+static inline void __DMB(void) { __asm__ volatile ("" ::: "memory"); }
+static inline void __DSB(void) { __asm__ volatile ("" ::: "memory"); }
+static inline void __NOP(void) {}
+static inline uint16_t __REV16(uint16_t v) { return (uint16_t)((v << 8) | (v >> 8)); }
+
+#endif /* STUB_STM32F1XX_HAL_H_ */
@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+"""Wandelt einen usbmon-Textmitschnitt in das xhc_replay Capture-Format.
+
+Mitschnitt am Host (Bus des Pendants, z.B. Bus 1):
+
+    sudo modprobe usbmon
+    sudo cat /sys/kernel/debug/usb/usbmon/1u > pendant.mon
+
+Übernommen werden die Submit-Zeilen der Control-Transfers
+SET_REPORT (bmRequestType 0x21, bRequest 0x09) mit Feature-Report 0x06:
+
+    ... S Co:1:005:0 s 21 09 0306 0000 0008 8 = 06fefd5a 0c000000
+
+    usbmon2cap.py pendant.mon > pendant.cap
+"""
+
+import sys
+
+
+def convert(lines, out):
+    out.write('# xhc-capture v1 (usbmon)\n')
+    t0 = None
+    n = 0
+    for line in lines:
+        f = line.split()
+        if len(f) < 12 or f[2] != 'S' or not f[3].startswith('Co:'):
+            continue
+        if f[4] != 's' or f[5] != '21' or f[6] != '09' or f[7] != '0306':
+            continue
+        if '=' not in f:
+            continue
+        data = ''.join(f[f.index('=') + 1:])
+        if len(data) < 16:
+            continue
+        t = int(f[1])
+        if t0 is None:
+            t0 = t
+        # Zeitstempel sind 32 Bit µs und laufen nach ~71 min über
+        out.write(f'{(t - t0) & 0xFFFFFFFF} {data[:16]}\n')
+        n += 1
+    return n
+
+
+def main():
+    src = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    n = convert(src, sys.stdout)
+    sys.stderr.write(f'{n} SET_REPORT 0x06 Transfers\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,259 @@
+/*
+ * xhc_replay.c
+ *
+ *  Spielt einen Mitschnitt von Host->Pendant Reports (SET_REPORT 0x06)
+ *  durch den unveränderten Decoder (xhc_integration.c) und die UI (ui.c)
+ *  gegen ein simuliertes Display und misst den Aufwand.
+ *
+ *  Capture-Format (Text, eine Zeile pro Control-Transfer):
+ *
+ *      # xhc-capture v1
+ *      <zeitstempel_us> <8 Byte hex: Report-ID 06 + 7 Byte Chunk>
+ *
+ *  z.B. "1234567 06fefd1b0c000000". Leerzeilen und '#'-Kommentare werden
+ *  ignoriert. Erzeugt mit usbmon2cap.py (Linux usbmon) oder gencap.py.
+ *
+ *  Aufruf:  xhc_replay [-r] [-s faktor] [-l loops] [-o bild.ppm] capture.txt
+ *      -r   Echtzeit (Zeitstempel einhalten), sonst maximale Geschwindigkeit
+ *      -s   Zeitfaktor für -r (2 = doppelt so schnell)
+ *      -l   Capture mehrfach abspielen
+ *      -o   Displayinhalt am Ende als PPM schreiben
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "xhc_integration.h"
+#include "usbd_customhid.h"
+#include "usbd_custom_hid_if.h"
+#include "defer.h"
+#include "sched.h"
+#include "settings.h"
+#include "sim_display.h"
+
+/* ----------------------------- HAL-Simulation ----------------------------- */
+
+GPIO_TypeDef   sim_gpioa, sim_gpiob;
+SPI_HandleTypeDef hspi1;
+DWT_Type       sim_dwt;
+CoreDebug_Type sim_coredebug;
+uint32_t       SystemCoreClock = 72000000U;
+
+static uint64_t sim_now_us = 0;   // simulierte Gerätezeit
+
+static void sim_set_time(uint64_t us) {
+    sim_now_us = us;
+    sim_dwt.CYCCNT = (uint32_t)(us * (SystemCoreClock / 1000000U));
+}
+
+uint32_t HAL_GetTick(void) { return (uint32_t)(sim_now_us / 1000U); }
+void HAL_Delay(uint32_t ms) { sim_set_time(sim_now_us + (uint64_t)ms * 1000U); }
+
+/* ----------------------------- USB-Simulation ----------------------------- */
+
+USBD_HandleTypeDef hUsbDeviceFS = { .dev_state = USBD_STATE_CONFIGURED };
+
+uint8_t USBD_CUSTOM_HID_SendReport(USBD_HandleTypeDef *pdev, uint8_t *report, uint16_t len) {
+    (void)pdev; (void)report; (void)len;
+    return USBD_OK;
+}
+
+/* Kein PendSV: das Tool ruft xhc_rx_work() direkt nach jedem Paket */
+void defer_register(defer_job_t job, defer_fn_t fn) { (void)job; (void)fn; }
+
+/* Kein Scheduler: xhc_main_loop() (Anzeige-Task) läuft nach jedem Paket */
+void sched_register(sched_task_t task, sched_fn_t fn, uint32_t period_ms,
+                    uint32_t events, uint32_t budget_us) {
+    (void)task; (void)fn; (void)period_ms; (void)events; (void)budget_us;
+}
+void sched_signal(uint32_t events) { (void)events; }
+
+/* Einstellungen: immer die Vorgabe (kein Flash) */
+uint32_t settings_get(settings_key_t key) { (void)key; return 0; }
+
+/* Empfangspuffer: das Tool ist Producer, xhc_rx_work() Consumer */
+static xhc_rx_item_t rx_ring[XHC_RX_RING_SIZE];
+static uint32_t rx_head, rx_tail, rx_dropped, rx_highwater;
+
+static void rx_push(const uint8_t *buf, uint16_t len) {
+    if (rx_head - rx_tail >= XHC_RX_RING_SIZE) { rx_dropped++; return; }
+    xhc_rx_item_t *item = &rx_ring[rx_head % XHC_RX_RING_SIZE];
+    item->len = len;
+    memcpy(item->data, buf, len);
+    rx_head++;
+    if (rx_head - rx_tail > rx_highwater) rx_highwater = rx_head - rx_tail;
+}
+
+const xhc_rx_item_t *XHC_RX_Peek(void) {
+    return (rx_head == rx_tail) ? NULL : &rx_ring[rx_tail % XHC_RX_RING_SIZE];
+}
+void XHC_RX_Commit(void) { rx_tail++; }
+uint32_t XHC_RX_Count(void) { return rx_head - rx_tail; }
+uint32_t XHC_RX_Dropped(void) { return rx_dropped; }
+uint32_t XHC_RX_HighWater(void) { return rx_highwater; }
+
+/* ------------------------------- Capture I/O ------------------------------ */
+
+typedef struct {
+    uint64_t t_us;
+    uint8_t  data[8];
+} cap_entry_t;
+
+static cap_entry_t *cap;
+static size_t cap_n, cap_cap;
+
+static int hexval(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int load_capture(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return -1; }
+
+    char line[256];
+    unsigned lineno = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == 0) continue;
+
+        char *end;
+        unsigned long long t = strtoull(p, &end, 10);
+        if (end == p) { fprintf(stderr, "%s:%u: Zeitstempel fehlt\n", path, lineno); fclose(f); return -1; }
+        p = end;
+        while (*p == ' ' || *p == '\t') p++;
+
+        cap_entry_t e = { .t_us = t };
+        for (int i = 0; i < 8; i++) {
+            int hi = hexval(p[2*i]), lo = hexval(p[2*i+1]);
+            if (hi < 0 || lo < 0) { fprintf(stderr, "%s:%u: 8 Byte hex erwartet\n", path, lineno); fclose(f); return -1; }
+            e.data[i] = (uint8_t)(hi << 4 | lo);
+        }
+
+        if (cap_n == cap_cap) {
+            cap_cap = cap_cap ? cap_cap * 2 : 1024;
+            cap = realloc(cap, cap_cap * sizeof(*cap));
+            if (!cap) { fclose(f); return -1; }
+        }
+        cap[cap_n++] = e;
+    }
+    fclose(f);
+    return 0;
+}
+
+/* --------------------------------- Replay --------------------------------- */
+
+static uint64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-r] [-s faktor] [-l loops] [-o bild.ppm] capture.txt\n", prog);
+}
+
+int main(int argc, char **argv) {
+    int realtime = 0, loops = 1, opt;
+    double speed = 1.0;
+    const char *ppm = NULL;
+
+    while ((opt = getopt(argc, argv, "rs:l:o:h")) != -1) {
+        switch (opt) {
+        case 'r': realtime = 1; break;
+        case 's': speed = atof(optarg); break;
+        case 'l': loops = atoi(optarg); break;
+        case 'o': ppm = optarg; break;
+        default:  usage(argv[0]); return 2;
+        }
+    }
+    if (optind != argc - 1 || speed <= 0.0 || loops < 1) { usage(argv[0]); return 2; }
+    if (load_capture(argv[optind]) != 0) return 1;
+    if (cap_n == 0) { fprintf(stderr, "leerer Mitschnitt\n"); return 1; }
+
+    sim_set_time(0);
+    xhc_init();
+    UI_DrawStatic();
+
+    sim_display_stats_t d0, d1;
+    sim_display_get_stats(&d0);
+
+    uint64_t span_us = cap[cap_n - 1].t_us - cap[0].t_us + 1000;
+    uint64_t packets = 0, frames = 0, rendered = 0;
+    uint64_t cost_total_ns = 0, cost_max_ns = 0;
+    uint64_t t_start = wall_ns();
+
+    for (int l = 0; l < loops; l++) {
+        for (size_t i = 0; i < cap_n; i++) {
+            uint64_t t_dev = (cap[i].t_us - cap[0].t_us) + (uint64_t)l * span_us;
+
+            if (realtime) {
+                uint64_t due = t_start + (uint64_t)((double)t_dev * 1000.0 / speed);
+                uint64_t now = wall_ns();
+                if (due > now) {
+                    struct timespec ts = { (time_t)((due - now) / 1000000000ULL),
+                                           (long)((due - now) % 1000000000ULL) };
+                    nanosleep(&ts, NULL);
+                }
+            }
+
+            sim_set_time(t_dev);
+            if (cap[i].data[0] == 0x06 && *(uint16_t*)&cap[i].data[1] == WHBxx_MAGIC) frames++;
+            rx_push(cap[i].data, 8);
+            packets++;
+
+            sim_display_stats_t before;
+            sim_display_get_stats(&before);
+
+            uint64_t t0 = wall_ns();
+            xhc_rx_work();
+            xhc_main_loop();
+            uint64_t dt = wall_ns() - t0;
+
+            sim_display_stats_t after;
+            sim_display_get_stats(&after);
+            if (after.spi_bytes != before.spi_bytes) rendered++;
+
+            cost_total_ns += dt;
+            if (dt > cost_max_ns) cost_max_ns = dt;
+        }
+    }
+
+    double wall_s = (double)(wall_ns() - t_start) / 1e9;
+    sim_display_get_stats(&d1);
+    uint64_t bytes = d1.spi_bytes - d0.spi_bytes;
+
+    printf("packets            %llu (%llu frames, %llu renders)\n",
+           (unsigned long long)packets, (unsigned long long)frames, (unsigned long long)rendered);
+    printf("wall time          %.3f s (%s)\n", wall_s, realtime ? "realtime" : "max speed");
+    printf("packets/s          %.0f\n", packets / wall_s);
+    printf("frames/s           %.0f\n", frames / wall_s);
+    printf("render bytes       %llu total, %.1f /packet, %.1f /frame\n",
+           (unsigned long long)bytes, (double)bytes / packets,
+           frames ? (double)bytes / frames : 0.0);
+    printf("spi transfers      %llu (%llu dma), %llu windows, %llu glyphs\n",
+           (unsigned long long)(d1.spi_transfers - d0.spi_transfers),
+           (unsigned long long)(d1.dma_starts - d0.dma_starts),
+           (unsigned long long)(d1.windows - d0.windows),
+           (unsigned long long)(d1.glyphs - d0.glyphs));
+    printf("spi time @18MHz    %.2f ms /frame\n",
+           frames ? (double)bytes * 8.0 / 18e6 * 1e3 / frames : 0.0);
+    printf("decode+render      %.2f us avg /packet, %.2f us max (host)\n",
+           (double)cost_total_ns / 1e3 / packets, (double)cost_max_ns / 1e3);
+    printf("rx ring            %u dropped, high water %u\n", rx_dropped, rx_highwater);
+
+    if (ppm && sim_display_write_ppm(ppm) != 0) {
+        perror(ppm);
+        return 1;
+    }
+    return 0;
+}
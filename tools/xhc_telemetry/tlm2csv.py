@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Dekodiert den Telemetrie-Strom des Pendants (CDC-ACM, telemetry.h) nach CSV.
+
+    tlm2csv.py /dev/ttyACM0 [-o telemetrie.csv]
+    tlm2csv.py mitschnitt.bin > telemetrie.csv
+
+Eine Zeile je Zeitstempel (tick_ms), eine Spalte je Feld aller bekannten
+Diagnoseseiten. Zusammenfassung (Datensätze, CRC-Fehler, Lücken) auf stderr.
+Firmware mit -DUSBD_CDC_TELEMETRY=1 bauen.
+"""
+
+import argparse
+import csv
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'xhc_diag'))
+from xhc_diag import PAGES  # noqa: E402
+
+SYNC = b'\xa5\x5a'
+HDR_LEN = 10
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def open_input(path):
+    fd = os.open(path, os.O_RDONLY | getattr(os, 'O_NOCTTY', 0))
+    if os.isatty(fd):
+        import termios
+        import tty
+        tty.setraw(fd)
+        attr = termios.tcgetattr(fd)
+        attr[6][termios.VMIN] = 1
+        attr[6][termios.VTIME] = 0
+        termios.tcsetattr(fd, termios.TCSANOW, attr)
+    return fd
+
+
+def records(fd, stats):
+    """Liefert (seite, seq, tick, werte) je gültigem Datensatz."""
+    buf = bytearray()
+    while True:
+        chunk = os.read(fd, 4096)
+        if not chunk:
+            return
+        buf += chunk
+        while True:
+            i = buf.find(SYNC)
+            if i < 0:
+                del buf[:max(0, len(buf) - 1)]
+                break
+            if i:
+                stats['skipped'] += i
+                del buf[:i]
+            if len(buf) < HDR_LEN:
+                break
+            page, n, seq, tick = struct.unpack_from('<BBHI', buf, 2)
+            total = HDR_LEN + 4 * n + 2
+            if n > 15:
+                stats['skipped'] += 1
+                del buf[:1]
+                continue
+            if len(buf) < total:
+                break
+            (crc,) = struct.unpack_from('<H', buf, total - 2)
+            if crc != crc16(buf[2:total - 2]):
+                stats['crc_errors'] += 1
+                del buf[:1]
+                continue
+            values = struct.unpack_from('<%dI' % n, buf, HDR_LEN)
+            del buf[:total]
+            yield page, seq, tick, values
+
+
+def columns():
+    cols = []
+    for page in sorted(PAGES):
+        name, fields = PAGES[page]
+        cols += ['%s.%s' % (name, f) for f in fields]
+    return cols
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument('input', help='ttyACM-Gerät oder Mitschnitt')
+    ap.add_argument('-o', '--output', help='CSV-Datei (Standard: stdout)')
+    args = ap.parse_args()
+
+    out = open(args.output, 'w', newline='') if args.output else sys.stdout
+    cols = columns()
+    writer = csv.DictWriter(out, fieldnames=['tick_ms'] + cols, extrasaction='ignore')
+    writer.writeheader()
+
+    stats = {'records': 0, 'rows': 0, 'crc_errors': 0, 'skipped': 0, 'lost': 0}
+    row, row_tick, last_seq = {}, None, None
+    fd = open_input(args.input)
+    try:
+        for page, seq, tick, values in records(fd, stats):
+            stats['records'] += 1
+            if last_seq is not None:
+                stats['lost'] += (seq - last_seq - 1) & 0xFFFF
+            last_seq = seq
+
+            if tick != row_tick and row:
+                writer.writerow(row)
+                out.flush()
+                stats['rows'] += 1
+                row = {}
+            row_tick = tick
+            row['tick_ms'] = tick
+
+            name, fields = PAGES.get(page, ('page%d' % page, []))
+            for i, v in enumerate(values):
+                if i < len(fields):
+                    row['%s.%s' % (name, fields[i])] = v
+    except KeyboardInterrupt:
+        pass
+    finally:
+        os.close(fd)
+        if row:
+            writer.writerow(row)
+            stats['rows'] += 1
+        if out is not sys.stdout:
+            out.close()
+
+    print('%(records)d Datensätze, %(rows)d Zeilen, %(crc_errors)d CRC-Fehler, '
+          '%(lost)d verloren, %(skipped)d Byte übersprungen' % stats, file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()